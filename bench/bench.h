@@ -0,0 +1,54 @@
+/*
+ * Shared helpers for the rc_sched benchmarks
+ *
+ * Every benchmark prints one JSON object per line on stdout so runs can
+ * be collected and compared across versions. Calls that are too cheap
+ * to time individually are measured in batches; the reported
+ * distribution is then that of the per-call mean within a batch.
+ */
+
+#ifndef RC_BENCH_H
+#define RC_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int bench_cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Sort `ns` in place and print {"bench":name,...}. `extra` is appended
+ * verbatim inside the object (e.g. "\"syscalls\":3") or may be NULL.
+ */
+static void bench_report(const char *name, double *ns, size_t n,
+                         const char *extra)
+{
+    if (n == 0)
+        return;
+
+    qsort(ns, n, sizeof(ns[0]), bench_cmp_double);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += ns[i];
+
+    printf("{\"bench\":\"%s\",\"n\":%zu,\"mean_ns\":%.1f,\"p50_ns\":%.1f,"
+           "\"p99_ns\":%.1f,\"max_ns\":%.1f%s%s}\n",
+           name, n, sum / n, ns[n / 2], ns[(size_t)(n * 0.99)], ns[n - 1],
+           extra ? "," : "", extra ? extra : "");
+    fflush(stdout);
+}
+
+#endif
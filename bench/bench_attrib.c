@@ -0,0 +1,140 @@
+/*
+ * Cost of a per-process heat attribution scan
+ *
+ * Forks a population of sleeping processes plus a few CPU spinners,
+ * then times attrib_scan() over the whole /proc. Scans are spaced
+ * --interval-ms apart (CPU time per scan does not depend on it) and
+ * cover several idle-reread cycles, so the mean is the steady-state
+ * cost. core_pct_at_1hz is that cost as a share of one core at one
+ * scan per second; --budget-pct turns it into a pass/fail gate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <getopt.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#include "bench.h"
+#include "attrib.h"
+
+#define MAX_SCANS   256
+
+static pid_t *children;
+static int n_children;
+
+static void spawn(int n, int busy)
+{
+    for (int i = 0; i < n; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return;
+        }
+        if (pid == 0) {
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (busy)
+                for (volatile unsigned long x = 0;; x++)
+                    ;
+            for (;;)
+                pause();
+        }
+        children[n_children++] = pid;
+    }
+}
+
+static void reap(void)
+{
+    for (int i = 0; i < n_children; i++)
+        kill(children[i], SIGKILL);
+    for (int i = 0; i < n_children; i++)
+        waitpid(children[i], NULL, 0);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "tasks",       required_argument, NULL, 'n' },
+        { "busy",        required_argument, NULL, 'b' },
+        { "scans",       required_argument, NULL, 'p' },
+        { "interval-ms", required_argument, NULL, 'i' },
+        { "budget-pct",  required_argument, NULL, 'B' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int tasks = 20000, busy = 2, scans = 4 * ATTRIB_IDLE_EVERY;
+    double interval_ms = 100.0, budget_pct = -1.0;
+    static double samples[MAX_SCANS];
+    int c;
+
+    while ((c = getopt_long(argc, argv, "n:b:p:i:B:h", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': tasks = atoi(optarg); break;
+        case 'b': busy = atoi(optarg); break;
+        case 'p': scans = atoi(optarg); break;
+        case 'i': interval_ms = atof(optarg); break;
+        case 'B': budget_pct = atof(optarg); break;
+        default:
+            fprintf(stderr,
+                "usage: %s [-n tasks] [-b busy] [-p scans] "
+                "[-i interval-ms] [-B budget-pct]\n", argv[0]);
+            return c == 'h' ? 0 : 2;
+        }
+    }
+    if (tasks < 0 || busy < 0 || scans < 1 || scans > MAX_SCANS) {
+        fprintf(stderr, "bad arguments\n");
+        return 2;
+    }
+
+    children = calloc((size_t)(tasks + busy), sizeof(*children));
+    if (!children || attrib_open(NULL) < 0) {
+        perror("setup");
+        return 2;
+    }
+    spawn(busy, 1);
+    spawn(tasks, 0);
+
+    /* Baseline, then the first delta: both read every process */
+    attrib_scan(2.4, 1.0);
+    double first_ms = attrib_last()->cost_ms;
+    usleep((useconds_t)(interval_ms * 1e3));
+    attrib_scan(2.4, 1.0);
+
+    unsigned long long read = 0, listed = 0;
+    for (int i = 0; i < scans; i++) {
+        usleep((useconds_t)(interval_ms * 1e3));
+        attrib_scan(2.4, 1.0);
+        samples[i] = attrib_last()->cost_ms * 1e6;
+        read += attrib_last()->read;
+        listed += attrib_last()->tasks;
+    }
+
+    /* How many of the spinners made it to the top of the last scan */
+    const struct attrib_pass *a = attrib_last();
+    int found = 0;
+    for (unsigned i = 0; i < a->n_top; i++)
+        for (int j = 0; j < busy; j++)
+            found += a->top[i].pid == children[j];
+
+    double mean_ms = 0.0;
+    for (int i = 0; i < scans; i++)
+        mean_ms += samples[i] / 1e6 / scans;
+    double pct = mean_ms / 10.0;    // ms per second -> % of a core
+    int over = budget_pct >= 0.0 && pct > budget_pct;
+
+    char extra[256];
+    snprintf(extra, sizeof(extra),
+             "\"tasks\":%.0f,\"read_per_scan\":%.0f,\"first_scan_ms\":%.2f,"
+             "\"core_pct_at_1hz\":%.2f,\"busy_in_top\":%d,\"busy\":%d,"
+             "\"pass\":%s",
+             (double)listed / scans, (double)read / scans, first_ms, pct,
+             found, busy, over ? "false" : "true");
+    bench_report("attrib_scan", samples, (size_t)scans, extra);
+
+    reap();
+    attrib_close();
+    return over;
+}
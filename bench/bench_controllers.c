@@ -0,0 +1,171 @@
+/*
+ * Cost of stepping many independent controllers per tick
+ *
+ * N librcthermal controllers (default 256) sit in one rct_group, each
+ * on its own in-memory zone so the numbers are controller time rather
+ * than sysfs time. Zones are spread over a range of ambients so part
+ * of them mitigate. Only rct_group_step() is timed; the plant update
+ * between ticks is not.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "bench.h"
+#include "rcthermal.h"
+
+#define PLANT_R     1.0
+#define PLANT_C     10.0
+#define PLANT_ALPHA 30.0
+#define F_MAX_KHZ   2400000
+
+struct zone {
+    double T;
+    double ambient;
+    int cap_khz;
+};
+
+static double vclock;           // virtual seconds, one per tick
+
+static double z_temperature(void *ctx)
+{
+    return ((struct zone *)ctx)->T;
+}
+
+static double z_frequency(void *ctx)
+{
+    return ((struct zone *)ctx)->cap_khz / 1e6;
+}
+
+static double z_utilization(void *ctx)
+{
+    (void)ctx;
+    return 0.7;
+}
+
+static int z_read_max(void *ctx)
+{
+    return ((struct zone *)ctx)->cap_khz;
+}
+
+static void z_write_max(void *ctx, int khz)
+{
+    ((struct zone *)ctx)->cap_khz = khz;
+}
+
+static int z_restore_max(void *ctx)
+{
+    struct zone *z = ctx;
+    if (z->cap_khz == F_MAX_KHZ)
+        return -1;
+    z->cap_khz = F_MAX_KHZ;
+    return 0;
+}
+
+static double z_now(void *ctx)
+{
+    (void)ctx;
+    return vclock;
+}
+
+static const struct platform_ops zone_platform = {
+    .read_temperature      = z_temperature,
+    .read_frequency        = z_frequency,
+    .read_utilization      = z_utilization,
+    .read_max_frequency    = z_read_max,
+    .write_max_frequency   = z_write_max,
+    .restore_max_frequency = z_restore_max,
+    .now                   = z_now,
+};
+
+static void plant_step(struct zone *z)
+{
+    double P = PLANT_ALPHA * z_utilization(z) * z_frequency(z);
+    z->T += (P - (z->T - z->ambient) / PLANT_R) / PLANT_C;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -n, --controllers N  controllers in the group (default 256)\n"
+        "  -t, --ticks N        timed ticks (default 20000)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "controllers", required_argument, NULL, 'n' },
+        { "ticks",       required_argument, NULL, 't' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    unsigned n = 256;
+    int ticks = 20000;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "n:t:h", opts, NULL)) != -1) {
+        switch (c) {
+        case 'n': n = (unsigned)atoi(optarg); break;
+        case 't': ticks = atoi(optarg); break;
+        default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (n == 0 || ticks <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct zone *zones = calloc(n, sizeof(*zones));
+    double *samples = malloc(ticks * sizeof(*samples));
+    struct rct_group g;
+    struct rc_params p;
+
+    if (!zones || !samples || rct_group_init(&g, n) < 0) {
+        perror("alloc");
+        return 1;
+    }
+    params_defaults(&p);
+
+    for (unsigned i = 0; i < n; i++) {
+        zones[i].ambient = 30.0 + 20.0 * i / n;
+        zones[i].T = zones[i].ambient;
+        zones[i].cap_khz = F_MAX_KHZ;
+
+        struct platform plat = { &zone_platform, &zones[i] };
+        rct_init(&g.slot[i].c, &plat, NULL);
+    }
+
+    for (int t = 0; t < ticks; t++) {
+        uint64_t t0 = bench_now_ns();
+        rct_group_step(&g, &p, (uint64_t)(vclock * 1e9));
+        samples[t] = (double)(bench_now_ns() - t0);
+
+        for (unsigned i = 0; i < n; i++)
+            plant_step(&zones[i]);
+        vclock += 1.0;
+    }
+
+    unsigned mitigating = 0;
+    for (unsigned i = 0; i < n; i++)
+        mitigating += rct_level(&g.slot[i].c) != RCT_LEVEL_NONE;
+
+    double sum = 0.0;
+    for (int t = 0; t < ticks; t++)
+        sum += samples[t];
+
+    char extra[128];
+    snprintf(extra, sizeof(extra),
+             "\"controllers\":%u,\"per_controller_ns\":%.1f,"
+             "\"mitigating\":%u", n, sum / ticks / n, mitigating);
+    bench_report("group_step", samples, ticks, extra);
+
+    rct_group_free(&g);
+    free(samples);
+    free(zones);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Hot-path latency and syscall cost
+ *
+ * Runs the sensor reads, the journaled cap write, the RC prediction
+ * and a full sample -> model -> actuate iteration against a fake sysfs
+ * tree in a temporary directory, so no privileges are needed and the
+ * numbers exclude driver time. Each result also carries the number of
+ * syscalls one call makes, counted by tracing a forked copy of this
+ * process with ptrace ("syscalls":null where ptrace is not allowed).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+
+#include "bench.h"
+#include "fake_sysfs.h"
+#include "controller.h"
+#include "config.h"
+#include "journal.h"
+#include "telemetry.h"
+#include "recorder.h"
+
+#define SAMPLES     20000
+#define BATCH       64          // for calls too cheap to time one by one
+#define TRACE_CALLS 100
+
+static double samples[SAMPLES];
+static volatile double sink;
+
+/* =======================
+   Syscall counting
+   ======================= */
+
+/*
+ * Syscalls per call of fn(): a traced child runs it `calls` times
+ * between two SIGUSR1 markers, and the same with no calls for the
+ * baseline the markers themselves cost. Returns -1 if ptrace fails.
+ */
+static int traced_run(void (*fn)(void), int calls)
+{
+    pid_t pid = fork();
+    if (pid < 0)
+        return -1;
+
+    if (pid == 0) {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) < 0)
+            _exit(1);
+        raise(SIGSTOP);
+        raise(SIGUSR1);
+        for (int i = 0; i < calls; i++)
+            fn();
+        raise(SIGUSR1);
+        _exit(0);
+    }
+
+    int st, markers = 0, entries = 0, in_call = 0;
+    if (waitpid(pid, &st, 0) < 0 || !WIFSTOPPED(st))
+        return -1;
+    ptrace(PTRACE_SETOPTIONS, pid, NULL,
+           (void *)(long)(PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL));
+
+    for (;;) {
+        if (ptrace(PTRACE_SYSCALL, pid, NULL, NULL) < 0 ||
+            waitpid(pid, &st, 0) < 0 || WIFEXITED(st) || WIFSIGNALED(st))
+            break;
+
+        int sig = WSTOPSIG(st);
+        if (sig == (SIGTRAP | 0x80)) {
+            in_call = !in_call;
+            if (in_call && markers == 1)
+                entries++;
+        }
+        else if (sig == SIGUSR1) {
+            /* swallow the marker: delivery would kill the child */
+            if (++markers == 2) {
+                kill(pid, SIGKILL);
+                waitpid(pid, &st, 0);
+                return entries;
+            }
+        }
+    }
+
+    return -1;
+}
+
+static void nothing(void)
+{
+}
+
+static void report(const char *name, void (*fn)(void), size_t n,
+                   int batch)
+{
+    char extra[96];
+    int base = traced_run(nothing, 0);
+    int total = base < 0 ? -1 : traced_run(fn, TRACE_CALLS);
+
+    if (total < 0)
+        snprintf(extra, sizeof(extra), "\"batch\":%d,\"syscalls\":null",
+                 batch);
+    else
+        snprintf(extra, sizeof(extra), "\"batch\":%d,\"syscalls\":%.2f",
+                 batch, (double)(total - base) / TRACE_CALLS);
+
+    bench_report(name, samples, n, extra);
+}
+
+/* =======================
+   Measured calls
+   ======================= */
+static void call_read_temperature(void)
+{
+    sink = sysfs_read_temperature(&fake_sysfs);
+}
+
+static void call_read_frequency(void)
+{
+    sink = sysfs_read_frequency(&fake_sysfs);
+}
+
+static void call_read_max_frequency(void)
+{
+    sink = sysfs_read_max_frequency(&fake_sysfs);
+}
+
+static void call_write_max_frequency(void)
+{
+    static int flip;
+    sysfs_write_max_frequency(&fake_sysfs,
+                              (flip ^= 1) ? 1680000 : 2400000);
+}
+
+static void call_predict_temperature(void)
+{
+    sink = predict_temperature(sink > 0 ? 65.0 : 64.0, 8.4, 30.0, 1.0,
+                               10.0, 1.0);
+}
+
+static void call_iteration(void)
+{
+    static struct sample_rec r;
+    r.seq++;
+    r.t_sample_ns = bench_now_ns();
+    sample_sensors(&r);
+    model_step(&r);
+    actuate(&r);
+}
+
+static void time_each(void (*fn)(void))
+{
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        fn();
+        samples[i] = (double)(bench_now_ns() - t0);
+    }
+}
+
+static void time_batched(void (*fn)(void))
+{
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int j = 0; j < BATCH; j++)
+            fn();
+        samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+    }
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        void (*fn)(void);
+        int batched;
+    } benches[] = {
+        { "read_temperature",    call_read_temperature,    0 },
+        { "read_frequency",      call_read_frequency,      0 },
+        { "read_max_frequency",  call_read_max_frequency,  0 },
+        { "write_max_frequency", call_write_max_frequency, 0 },
+        { "predict_temperature", call_predict_temperature, 1 },
+        { "control_iteration",   call_iteration,           0 },
+    };
+    char path[128];
+
+    if (fake_sysfs_setup() < 0) {
+        perror("fake sysfs");
+        return 1;
+    }
+
+    /* Everything a live iteration touches, inside the fake root */
+    snprintf(path, sizeof(path), "%s/journal", fake_root);
+    journal_open(path);
+    snprintf(path, sizeof(path), "%s/telemetry", fake_root);
+    telemetry_open(path);
+    snprintf(path, sizeof(path), "%s/samples.rec", fake_root);
+    recorder_open(path, RECORDER_DEFAULT_MB << 20);
+    controller_configure(0, 0);
+
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (benches[i].batched)
+            time_batched(benches[i].fn);
+        else
+            time_each(benches[i].fn);
+        report(benches[i].name, benches[i].fn, SAMPLES,
+               benches[i].batched ? BATCH : 1);
+    }
+
+    journal_restore_all();
+    recorder_close();
+    telemetry_close();
+    params_shutdown();
+    fake_sysfs_cleanup();
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * Per-tick self-overhead of the running pipeline
+ *
+ * Runs the real sampler -> model -> actuator threads with the live
+ * controller against a fake sysfs tree and prints what selfstat
+ * accounted per tick. With --budget-us (and optionally
+ * --budget-syscalls) it exits non-zero when the average exceeds the
+ * budget, so `make bench-budget` can gate changes to the hot path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "fake_sysfs.h"
+#include "controller.h"
+#include "pipeline.h"
+#include "selfstat.h"
+#include "config.h"
+#include "journal.h"
+#include "telemetry.h"
+#include "headroom.h"
+#include "recorder.h"
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -r, --rate-hz N          tick rate (default 1000)\n"
+        "  -d, --seconds S          run time (default 3)\n"
+        "  -b, --budget-us US       fail if average CPU per tick exceeds US\n"
+        "  -y, --budget-syscalls N  fail if average syscalls per tick exceed N\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "rate-hz",         required_argument, NULL, 'r' },
+        { "seconds",         required_argument, NULL, 'd' },
+        { "budget-us",       required_argument, NULL, 'b' },
+        { "budget-syscalls", required_argument, NULL, 'y' },
+        { "help",            no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    double rate = 1000.0, seconds = 3.0;
+    double budget_us = -1.0, budget_sys = -1.0;
+    char path[128];
+    int c;
+
+    while ((c = getopt_long(argc, argv, "r:d:b:y:h", opts, NULL)) != -1) {
+        switch (c) {
+        case 'r': rate = atof(optarg); break;
+        case 'd': seconds = atof(optarg); break;
+        case 'b': budget_us = atof(optarg); break;
+        case 'y': budget_sys = atof(optarg); break;
+        default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 2;
+        }
+    }
+    if (rate <= 0.0 || seconds <= 0.0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (fake_sysfs_setup() < 0) {
+        perror("fake sysfs");
+        return 2;
+    }
+
+    snprintf(path, sizeof(path), "%s/journal", fake_root);
+    journal_open(path);
+    snprintf(path, sizeof(path), "%s/telemetry", fake_root);
+    telemetry_open(path);
+    snprintf(path, sizeof(path), "%s/headroom", fake_root);
+    headroom_open(path);
+    snprintf(path, sizeof(path), "%s/samples.rec", fake_root);
+    recorder_open(path, RECORDER_DEFAULT_MB << 20);
+    controller_configure(0, 0);
+    controller_quiet(1);
+
+    if (pipeline_start(&controller_ops, (uint64_t)(1e9 / rate), NULL) < 0) {
+        perror("pipeline");
+        fake_sysfs_cleanup();
+        return 2;
+    }
+    usleep((useconds_t)(seconds * 1e6));
+    pipeline_stop();
+
+    struct selfstat s;
+    selfstat_get(&s);
+
+    int over = (budget_us >= 0.0 && s.cpu_us_avg > budget_us) ||
+               (budget_sys >= 0.0 && s.syscalls_ok &&
+                s.syscalls_avg > budget_sys);
+
+    printf("{\"bench\":\"overhead_per_tick\",\"rate_hz\":%.0f,"
+           "\"ticks\":%llu,\"cpu_us_avg\":%.2f,\"cpu_us_max\":%.1f,",
+           rate, (unsigned long long)s.ticks, s.cpu_us_avg, s.cpu_us_max);
+    if (s.syscalls_ok)
+        printf("\"syscalls_avg\":%.2f,\"syscalls_max\":%.0f,",
+               s.syscalls_avg, s.syscalls_max);
+    else
+        printf("\"syscalls_avg\":null,\"syscalls_max\":null,");
+    printf("\"csw_avg\":%.2f,\"csw_max\":%.0f,\"rss_kb_avg\":%.0f,"
+           "\"rss_kb_max\":%.0f",
+           s.csw_avg, s.csw_max, s.rss_kb_avg, s.rss_kb_max);
+    if (budget_us >= 0.0)
+        printf(",\"budget_us\":%.1f", budget_us);
+    if (budget_sys >= 0.0)
+        printf(",\"budget_syscalls\":%.1f", budget_sys);
+    printf(",\"pass\":%s}\n", over ? "false" : "true");
+
+    journal_restore_all();
+    recorder_close();
+    telemetry_close();
+    headroom_close();
+    params_shutdown();
+    fake_sysfs_cleanup();
+
+    if (over)
+        fprintf(stderr, "bench_overhead: per-tick overhead over budget\n");
+    return over;
+}
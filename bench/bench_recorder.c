@@ -0,0 +1,99 @@
+/*
+ * Per-sample logging cost
+ *
+ * Compares recorder_append() against formatting the per-tick console
+ * line it replaced (snprintf only, no write) and against printing it
+ * to a file through stdio. The workload is a slow temperature drift
+ * with noise and an occasional actuator change, so both delta slots
+ * and key frames are exercised.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "recorder.h"
+
+#define BENCH_PATH  "/dev/shm/rc_bench.rec"
+#define SAMPLES     20000
+#define BATCH       64
+
+static double samples[SAMPLES];
+
+static void next_sample(struct rc_telem_data *d, unsigned i)
+{
+    d->sample_seq = i;
+    d->t_sample_ns += 100000000ULL;
+    d->valid = 1;
+    d->zones[0].temp_c = 60.0 + 15.0 * sin(i / 5000.0) + (i * 7 % 13) * 0.01;
+    d->zones[0].pred_c = d->zones[0].temp_c + 0.4;
+    d->freq_ghz = 2.4 - (i * 3 % 5) * 0.1;
+    d->util = 0.7;
+    d->power_w = 10.0 * d->util * d->freq_ghz;
+    d->mitigation_level = (i / 4096) & 1;
+    d->cap_khz = d->mitigation_level ? 1680000 : -1;
+    d->uclamp_pct = 100.0;
+}
+
+int main(void)
+{
+    struct rc_telem_data d;
+    char line[256];
+    unsigned n = 0;
+
+    if (recorder_open(BENCH_PATH, RECORDER_DEFAULT_MB << 20) < 0)
+        return 1;
+
+    memset(&d, 0, sizeof(d));
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int j = 0; j < BATCH; j++) {
+            next_sample(&d, n++);
+            recorder_append(&d, 0);
+        }
+        samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+    }
+    bench_report("recorder_append", samples, SAMPLES, "\"batch\":64");
+
+    memset(&d, 0, sizeof(d));
+    n = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int j = 0; j < BATCH; j++) {
+            next_sample(&d, n++);
+            snprintf(line, sizeof(line),
+                     "T=%.2f°C | T_pred=%.2f°C | f=%.2f GHz | P=%.2f W\n",
+                     d.zones[0].temp_c, d.zones[0].pred_c, d.freq_ghz,
+                     d.power_w);
+        }
+        samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+    }
+    bench_report("printf_line_format", samples, SAMPLES, "\"batch\":64");
+
+    FILE *fp = fopen("/dev/null", "w");
+    if (fp) {
+        setvbuf(fp, NULL, _IOLBF, 0);       // what a terminal gets
+        memset(&d, 0, sizeof(d));
+        n = 0;
+        for (int i = 0; i < SAMPLES; i++) {
+            uint64_t t0 = bench_now_ns();
+            for (int j = 0; j < BATCH; j++) {
+                next_sample(&d, n++);
+                fprintf(fp,
+                        "T=%.2f°C | T_pred=%.2f°C | f=%.2f GHz | P=%.2f W\n",
+                        d.zones[0].temp_c, d.zones[0].pred_c, d.freq_ghz,
+                        d.power_w);
+            }
+            samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+        }
+        bench_report("printf_line_buffered", samples, SAMPLES,
+                     "\"batch\":64");
+        fclose(fp);
+    }
+
+    recorder_close();
+    unlink(BENCH_PATH);
+    return 0;
+}
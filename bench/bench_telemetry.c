@@ -0,0 +1,91 @@
+/*
+ * Telemetry read/publish cost
+ *
+ * Measures rc_telem_read() with an idle writer and with a writer
+ * publishing back to back (worst case for seqlock retries), and the
+ * cost of telemetry_publish() itself.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "bench.h"
+#include "telemetry.h"
+
+#define BENCH_PATH  "/dev/shm/rc_bench.telemetry"
+#define SAMPLES     20000
+#define BATCH       64
+
+static double samples[SAMPLES];
+static atomic_int writer_run;
+
+static void *writer(void *arg)
+{
+    (void)arg;
+    struct rc_telem_data d;
+    memset(&d, 0, sizeof(d));
+    d.n_zones = RC_TELEM_MAX_ZONES;
+
+    while (atomic_load_explicit(&writer_run, memory_order_relaxed)) {
+        d.sample_seq++;
+        telemetry_publish(&d);
+    }
+    return NULL;
+}
+
+static void bench_read(struct rc_telem *t, const char *name)
+{
+    struct rc_telem_data d;
+    unsigned long failures = 0;
+
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int j = 0; j < BATCH; j++)
+            failures += rc_telem_read(t, &d) != 0;
+        samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+    }
+
+    char extra[64];
+    snprintf(extra, sizeof(extra), "\"batch\":%d,\"failures\":%lu",
+             BATCH, failures);
+    bench_report(name, samples, SAMPLES, extra);
+}
+
+int main(void)
+{
+    if (telemetry_open(BENCH_PATH) < 0)
+        return 1;
+
+    struct rc_telem *t = rc_telem_open(BENCH_PATH);
+    if (!t) {
+        fprintf(stderr, "cannot open %s as reader\n", BENCH_PATH);
+        return 1;
+    }
+
+    struct rc_telem_data d;
+    memset(&d, 0, sizeof(d));
+    for (int i = 0; i < SAMPLES; i++) {
+        uint64_t t0 = bench_now_ns();
+        for (int j = 0; j < BATCH; j++) {
+            d.sample_seq++;
+            telemetry_publish(&d);
+        }
+        samples[i] = (double)(bench_now_ns() - t0) / BATCH;
+    }
+    bench_report("telemetry_publish", samples, SAMPLES, "\"batch\":64");
+
+    bench_read(t, "telemetry_read_idle_writer");
+
+    pthread_t w;
+    atomic_store(&writer_run, 1);
+    pthread_create(&w, NULL, writer, NULL);
+    bench_read(t, "telemetry_read_busy_writer");
+    atomic_store(&writer_run, 0);
+    pthread_join(w, NULL);
+
+    rc_telem_close(t);
+    telemetry_close();
+    return 0;
+}
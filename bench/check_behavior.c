@@ -0,0 +1,300 @@
+/*
+ * Behaviour checks for the controller's building blocks
+ *
+ * Not a benchmark: each check drives one module with a scripted input
+ * and compares the outcome with what its header promises. Results are
+ * printed one JSON object per line like the benchmarks; the exit
+ * status is the number of failed checks, so `make check` stops on a
+ * regression.
+ *
+ *  - ramp: a power step is flagged within threshold / (dP - drift)
+ *    seconds at any sampling rate, and noise below drift never is
+ *  - trips: thresholds derived from trip points, including trips
+ *    closer together than the offsets
+ *  - caps: every policy gets the first one's share of its own
+ *    original maximum, within its cpuinfo limits, and gets it back
+ *  - health: a frozen sensor is flagged stuck, a saturated one that
+ *    sits where the model expects it is not
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+
+#include "fake_sysfs.h"
+#include "params.h"
+#include "ramp.h"
+#include "trips.h"
+#include "health.h"
+#include "journal.h"
+
+static int failed;
+
+static void check(const char *name, int ok, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void check(const char *name, int ok, const char *fmt, ...)
+{
+    char detail[256];
+    va_list ap;
+
+    va_start(ap, fmt);
+    vsnprintf(detail, sizeof(detail), fmt, ap);
+    va_end(ap);
+
+    printf("{\"check\":\"%s\",\"ok\":%s,%s}\n", name,
+           ok ? "true" : "false", detail);
+    failed += !ok;
+}
+
+static int near(double a, double b)
+{
+    return fabs(a - b) < 1e-6;
+}
+
+/* =======================
+   Ramp detection
+   ======================= */
+
+/*
+ * `p0` W until t_step, then `p1` W, sampled every dt; returns the
+ * delay from the step to the first flagged sample, -1 if never within
+ * `span` seconds, -2 if flagged before the step
+ */
+static double ramp_delay(double dt, double p0, double p1, double noise,
+                         double t_step, double span)
+{
+    const struct rc_params *p = &params_builtin;
+    struct ramp r;
+    ramp_reset(&r);
+
+    for (int i = 0; i * dt <= t_step + span; i++) {
+        double t = i * dt;
+        double pw = t < t_step ? p0 : p1;
+        pw += i % 2 ? noise : -noise;
+        if (ramp_update(&r, t, pw, p->ramp_drift, p->ramp_threshold))
+            return t < t_step ? -2.0 : t - t_step;
+    }
+    return -1.0;
+}
+
+static void check_ramp(void)
+{
+    const struct rc_params *p = &params_builtin;
+    static const double periods[] = { 0.05, 0.2, 1.0 };
+    double dP = 10.0;
+    double expect = p->ramp_threshold / (dP - p->ramp_drift);
+
+    for (size_t i = 0; i < sizeof(periods) / sizeof(periods[0]); i++) {
+        double dt = periods[i];
+        double d = ramp_delay(dt, 15.0, 15.0 + dP, 0.0, 120.0, 30.0);
+        char name[32];
+
+        /* the sum crosses the threshold within one sample of expect */
+        snprintf(name, sizeof(name), "ramp_step_%.0fms", dt * 1e3);
+        check(name, d >= 0.0 && d >= expect - dt && d <= expect + dt,
+              "\"delay_s\":%.3f,\"expect_s\":%.3f", d, expect);
+    }
+
+    double d = ramp_delay(0.2, 15.0, 15.0, 0.9 * p->ramp_drift, 0.0,
+                          600.0);
+    check("ramp_noise_below_drift", d == -1.0, "\"delay_s\":%.3f", d);
+}
+
+/* =======================
+   Trip-derived thresholds
+   ======================= */
+struct trip_case {
+    const char *name;
+    double passive, critical;
+    int rc;
+    double high, low, crit;             // expected, when rc != 0
+};
+
+static void check_trips(void)
+{
+    /* defaults: high 75, low 70, critical 85; offsets 5 and 10 */
+    static const struct trip_case cases[] = {
+        { "trips_derived",        100.0, 110.0, 1, 95.0, 90.0, 100.0 },
+        { "trips_critical_only",    0.0, 100.0, 1, 80.0, 75.0,  90.0 },
+        { "trips_passive_only",   100.0,   0.0, 1, 95.0, 90.0, 105.0 },
+        /* offsets would put t_critical at t_high: raised above it */
+        { "trips_collide",         95.0, 100.0, 2, 90.0, 85.0,  91.0 },
+        /* raising it would cross the critical trip: both go below */
+        { "trips_collide_crossed", 105.0, 100.0, 2, 98.0, 93.0, 99.0 },
+        /* t_low would fall to ambient: keep the fixed set */
+        { "trips_too_low",         36.0,   0.0, 0, 75.0, 70.0,  85.0 },
+    };
+    struct rc_params base, out;
+    params_defaults(&base);
+    base.trip_auto = 1.0;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const struct trip_case *c = &cases[i];
+        struct trips t = { c->passive, c->critical };
+        int rc = trips_thresholds(&base, &t, &out);
+
+        int ok = rc == c->rc && near(out.t_high, c->high) &&
+                 near(out.t_low, c->low) && near(out.t_critical, c->crit);
+        /* whatever the clamping, the order must hold */
+        ok = ok && out.t_low < out.t_high &&
+             out.t_high < out.t_critical &&
+             (c->critical <= 0.0 || out.t_critical < c->critical);
+        check(c->name, ok,
+              "\"rc\":%d,\"t_high\":%.1f,\"t_low\":%.1f,"
+              "\"t_critical\":%.1f", rc, out.t_high, out.t_low,
+              out.t_critical);
+    }
+
+    base.trip_auto = 0.0;
+    struct trips t = { 100.0, 110.0 };
+    int rc = trips_thresholds(&base, &t, &out);
+    check("trips_auto_off", rc == 0 && near(out.t_high, base.t_high),
+          "\"rc\":%d,\"t_high\":%.1f", rc, out.t_high);
+}
+
+/* =======================
+   Per-policy caps
+   ======================= */
+struct policy {
+    int cpu;
+    int orig, min, max;                 // kHz
+    int capped;                         // expected at the test cap
+};
+
+#define CAP_KHZ 3500000                 // 70 % of cpu0's original
+
+static int read_policy_max(int cpu)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/sys/devices/system/cpu/cpu%d/"
+             "cpufreq/scaling_max_freq", fake_root, cpu);
+
+    FILE *fp = fopen(path, "r");
+    int khz = -1;
+    if (fp) {
+        if (fscanf(fp, "%d", &khz) != 1)
+            khz = -1;
+        fclose(fp);
+    }
+    return khz;
+}
+
+static int put_policy(int cpu, const char *attr, int khz)
+{
+    char rel[128], val[16];
+    snprintf(rel, sizeof(rel), "/sys/devices/system/cpu/cpu%d/cpufreq/%s",
+             cpu, attr);
+    snprintf(val, sizeof(val), "%d\n", khz);
+    return fake_put(rel, val);
+}
+
+static void check_caps(void)
+{
+    /* a P-core with turbo, a P-core without, an E-core cluster */
+    static const struct policy pol[] = {
+        { 0, 5000000, 800000, 5000000, 3500000 },
+        { 2, 4000000, 400000, 4000000, 2800000 },
+        { 4, 3000000, 2500000, 3000000, 2500000 },   // held at its min
+    };
+    const int n = sizeof(pol) / sizeof(pol[0]);
+    struct sysfs_ctx s;
+    char path[256];
+
+    for (int i = 0; i < n; i++)
+        if (put_policy(pol[i].cpu, "scaling_max_freq", pol[i].orig) < 0 ||
+            put_policy(pol[i].cpu, "cpuinfo_min_freq", pol[i].min) < 0 ||
+            put_policy(pol[i].cpu, "cpuinfo_max_freq", pol[i].max) < 0) {
+            check("caps_setup", 0, "\"root\":\"%s\"", fake_root);
+            return;
+        }
+
+    snprintf(path, sizeof(path), "%s/journal", fake_root);
+    journal_open(path);
+
+    sysfs_init(&s, fake_root, 0, pol[0].cpu);
+    for (int i = 1; i < n; i++)
+        sysfs_add_policy(&s, pol[i].cpu);
+
+    sysfs_write_max_frequency(&s, CAP_KHZ);
+    for (int i = 0; i < n; i++) {
+        char name[32];
+        int khz = read_policy_max(pol[i].cpu);
+        snprintf(name, sizeof(name), "caps_cpu%d", pol[i].cpu);
+        check(name, khz == pol[i].capped,
+              "\"khz\":%d,\"expect_khz\":%d", khz, pol[i].capped);
+    }
+
+    int rc = sysfs_restore_max_frequency(&s);
+    int restored = rc == 0;
+    for (int i = 0; i < n; i++)
+        restored = restored && read_policy_max(pol[i].cpu) == pol[i].orig;
+    check("caps_restore", restored, "\"rc\":%d", rc);
+}
+
+/* =======================
+   Sensor health
+   ======================= */
+
+/*
+ * Feed `raw` every second for `span` seconds while the model expects
+ * `expect` +- `swing`; returns the last filtered value
+ */
+static double health_run(struct sensor_health *h, double raw,
+                         double expect, double swing, double span)
+{
+    const struct rc_params *p = &params_builtin;
+    struct health_limits lim = {
+        (unsigned)p->sensor_stale_reads, p->sensor_stuck_time,
+        p->sensor_stuck_delta
+    };
+    double v = -1.0;
+
+    for (int i = 0; i <= (int)span; i++)
+        v = health_filter(h, &lim, i, raw,
+                          expect + (i % 20 < 10 ? swing : -swing), 0.0);
+    return v;
+}
+
+static void check_health(void)
+{
+    const struct rc_params *p = &params_builtin;
+    double span = p->sensor_stuck_time + p->sensor_stale_reads + 10.0;
+    struct sensor_health h;
+
+    /* frozen at 60 while the load swings the model by 2 * 5 °C */
+    health_reset(&h);
+    double v = health_run(&h, 60.0, 60.0, 5.0, span);
+    check("health_frozen_stuck", h.st.stuck && h.st.stuck_events == 1 &&
+          v < 0.0, "\"stuck\":%d,\"events\":%llu,\"value\":%.1f",
+          h.st.stuck, (unsigned long long)h.st.stuck_events, v);
+
+    /* quantized sensor pinned at 95 on a saturated package */
+    health_reset(&h);
+    v = health_run(&h, 95.0, 95.5, 0.0, span * 2);
+    check("health_saturated_not_stuck", !h.st.stuck && near(v, 95.0),
+          "\"stuck\":%d,\"value\":%.1f", h.st.stuck, v);
+
+    /* within the sensor's resolution is not enough to call it stuck */
+    health_reset(&h);
+    v = health_run(&h, 70.0, 70.0, 0.4 * p->sensor_stuck_delta, span);
+    check("health_small_swing_not_stuck", !h.st.stuck && near(v, 70.0),
+          "\"stuck\":%d,\"value\":%.1f", h.st.stuck, v);
+}
+
+int main(void)
+{
+    if (fake_sysfs_setup() < 0) {
+        perror("fake sysfs");
+        return 1;
+    }
+
+    check_ramp();
+    check_trips();
+    check_caps();
+    check_health();
+
+    fake_sysfs_cleanup();
+    return failed;
+}
@@ -0,0 +1,77 @@
+/*
+ * Fake sysfs tree for the rc_sched benchmarks
+ *
+ * Creates the files the controller reads and writes under a temporary
+ * directory and binds the daemon's controller to it, so benchmarks
+ * run unprivileged and measure rc_sched rather than driver time.
+ */
+
+#ifndef RC_FAKE_SYSFS_H
+#define RC_FAKE_SYSFS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "sysfs.h"
+#include "controller.h"
+
+static char fake_root[64];
+static struct sysfs_ctx fake_sysfs;
+
+static int fake_mkdirs(const char *path)
+{
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", path);
+    for (char *s = buf + 1; *s; s++) {
+        if (*s != '/')
+            continue;
+        *s = '\0';
+        mkdir(buf, 0755);
+        *s = '/';
+    }
+    return mkdir(buf, 0755);
+}
+
+static int fake_put(const char *rel, const char *value)
+{
+    char path[256], dir[256];
+    snprintf(path, sizeof(path), "%s%s", fake_root, rel);
+    snprintf(dir, sizeof(dir), "%s", path);
+    *strrchr(dir, '/') = '\0';
+    fake_mkdirs(dir);
+
+    FILE *fp = fopen(path, "w");
+    if (!fp)
+        return -1;
+    fputs(value, fp);
+    fclose(fp);
+    return 0;
+}
+
+static int fake_sysfs_setup(void)
+{
+    snprintf(fake_root, sizeof(fake_root), "/tmp/rc_bench_sysfs.XXXXXX");
+    if (!mkdtemp(fake_root))
+        return -1;
+
+    if (fake_put(TEMP_PATH, "65000\n") < 0 ||
+        fake_put(FREQ_CUR_PATH, "2400000\n") < 0 ||
+        fake_put(FREQ_MAX_PATH, "2400000\n") < 0)
+        return -1;
+
+    sysfs_init(&fake_sysfs, fake_root, 0, 0);
+    controller_platform(&sysfs_platform, &fake_sysfs);
+    return 0;
+}
+
+static void fake_sysfs_cleanup(void)
+{
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "rm -rf '%s'", fake_root);
+    if (system(cmd) != 0)
+        fprintf(stderr, "could not remove %s\n", fake_root);
+}
+
+#endif
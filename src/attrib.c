@@ -0,0 +1,392 @@
+/*
+ * Per-process heat attribution
+ *
+ * The scan keeps /proc open and lists it with getdents64 into a static
+ * buffer, opens each stat file relative to it and parses in place, so
+ * it allocates nothing. Per-process state lives in two fixed hash
+ * tables, one for the previous scan and one for the current: a slot
+ * belongs to a table only if it carries that table's scan number, so
+ * switching tables needs no clearing and exited processes simply drop
+ * out. Most processes sleep, and those idle at their last read are
+ * re-read only on every ATTRIB_IDLE_EVERY-th scan (staggered by pid),
+ * and /proc itself is listed only every ATTRIB_LIST_EVERY-th scan (in
+ * between, the known processes are revisited), which is what keeps a
+ * scan of tens of thousands of processes cheap. A process started
+ * since the last listing is found at the next one and charged all of
+ * its CPU time then.
+ *
+ * CPU time a process used after its last read and before it exited is
+ * not attributed.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/syscall.h>
+
+#include "attrib.h"
+
+#define DENTS_BUF       32768
+#define STAT_BUF        512
+
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t  d_off;
+    uint16_t d_reclen;
+    uint8_t  d_type;
+    char     d_name[];
+};
+
+struct entry {
+    int32_t  pid;
+    uint32_t pass;                  // slot is live in the table for `pass`
+    uint32_t t_ms;                  // CLOCK_BOOTTIME of the last read
+    uint32_t idle;                  // no CPU time at the last read
+    uint64_t start;                 // starttime, tells reused pids apart
+    uint64_t ticks;                 // utime + stime
+};
+
+static struct entry tables[2][ATTRIB_SLOTS];
+static char dents[DENTS_BUF] __attribute__((aligned(8)));
+
+static int proc_fd = -1;
+static uint32_t pass = 1;           // table[pass & 1] is the current one
+static unsigned n_cur;
+static uint64_t prev_scan_ns, prev_list_ns;
+static double watts_per_cpu;        // alpha * f / n_cpus for this scan
+static long clk_tck, n_cpus;
+
+static struct attrib_task heap[ATTRIB_TOP];    // min-heap on cpus
+static unsigned n_heap;
+static struct attrib_pass last;
+
+static uint64_t clock_ns(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int attrib_open(const char *proc_root)
+{
+    proc_fd = open(proc_root ? proc_root : "/proc",
+                   O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (proc_fd < 0)
+        return -1;
+
+    clk_tck = sysconf(_SC_CLK_TCK);
+    n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (clk_tck <= 0)
+        clk_tck = 100;
+    if (n_cpus <= 0)
+        n_cpus = 1;
+
+    return 0;
+}
+
+/* =======================
+   Process table
+   ======================= */
+static struct entry *slot(struct entry *tab, uint32_t p, int pid, int insert)
+{
+    uint32_t i = ((uint32_t)pid * 2654435761u) & (ATTRIB_SLOTS - 1);
+
+    for (unsigned n = 0; n < ATTRIB_SLOTS; n++) {
+        struct entry *e = &tab[i];
+        if (e->pass != p)
+            return insert ? e : NULL;
+        if (e->pid == pid)
+            return e;
+        i = (i + 1) & (ATTRIB_SLOTS - 1);
+    }
+
+    return NULL;
+}
+
+/* =======================
+   Top contributors
+   ======================= */
+static void heap_swap(unsigned a, unsigned b)
+{
+    struct attrib_task t = heap[a];
+    heap[a] = heap[b];
+    heap[b] = t;
+}
+
+static void heap_offer(const struct attrib_task *t)
+{
+    unsigned i;
+
+    if (n_heap < ATTRIB_TOP) {
+        i = n_heap++;
+        heap[i] = *t;
+        while (i > 0 && heap[(i - 1) / 2].cpus > heap[i].cpus) {
+            heap_swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+        return;
+    }
+
+    if (t->cpus <= heap[0].cpus)
+        return;
+
+    heap[0] = *t;
+    for (i = 0;;) {
+        unsigned l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n_heap && heap[l].cpus < heap[m].cpus) m = l;
+        if (r < n_heap && heap[r].cpus < heap[m].cpus) m = r;
+        if (m == i)
+            break;
+        heap_swap(i, m);
+        i = m;
+    }
+}
+
+static int cmp_hotter(const void *a, const void *b)
+{
+    double x = ((const struct attrib_task *)a)->cpus;
+    double y = ((const struct attrib_task *)b)->cpus;
+    return (x < y) - (x > y);
+}
+
+/* =======================
+   Scan
+   ======================= */
+static uint64_t field_u64(const char **s)
+{
+    const char *p = *s;
+    uint64_t v = 0;
+
+    while (*p == ' ')
+        p++;
+    while (*p >= '0' && *p <= '9')
+        v = v * 10 + (uint64_t)(*p++ - '0');
+    while (*p && *p != ' ')
+        p++;
+
+    *s = p;
+    return v;
+}
+
+/* comm, utime + stime and starttime from a NUL-terminated stat line */
+static int parse_stat(const char *buf, char comm[16], uint64_t *ticks,
+                      uint64_t *start)
+{
+    /* comm may itself contain spaces and parentheses */
+    const char *open = strchr(buf, '(');
+    const char *close = strrchr(buf, ')');
+    if (!open || !close || close < open)
+        return -1;
+
+    size_t len = (size_t)(close - open - 1);
+    if (len > 15)
+        len = 15;
+    memcpy(comm, open + 1, len);
+    comm[len] = '\0';
+
+    /* Fields after comm, counting from 3 (state) */
+    const char *p = close + 1;
+    uint64_t utime = 0, stime = 0;
+    for (int field = 3; field <= 22 && *p; field++) {
+        uint64_t v = field_u64(&p);
+        if (field == 14)
+            utime = v;
+        else if (field == 15)
+            stime = v;
+        else if (field == 22) {
+            *ticks = utime + stime;
+            *start = v;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static int pid_of(const char *name)
+{
+    int pid = 0;
+
+    if (!*name)
+        return 0;
+    for (; *name; name++) {
+        if (*name < '0' || *name > '9')
+            return 0;
+        pid = pid * 10 + (*name - '0');
+    }
+
+    return pid;
+}
+
+static void visit(int pid, uint64_t now_ns, struct attrib_pass *res)
+{
+    const struct entry *old = slot(tables[(pass - 1) & 1], pass - 1, pid, 0);
+    uint32_t now_ms = (uint32_t)(now_ns / 1000000);
+
+    if (n_cur >= ATTRIB_SLOTS / 4 * 3) {
+        res->untracked++;
+        return;
+    }
+    struct entry *e = slot(tables[pass & 1], pass, pid, 1);
+
+    if (old && old->idle && ((uint32_t)pid + pass) % ATTRIB_IDLE_EVERY) {
+        *e = *old;
+        e->pass = pass;
+        n_cur++;
+        return;
+    }
+
+    char path[24], buf[STAT_BUF], comm[16];
+    snprintf(path, sizeof(path), "%d/stat", pid);
+    int fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;                     // exited since it was listed
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    close(fd);
+    if (n <= 0)
+        return;
+    buf[n] = '\0';
+
+    uint64_t ticks, start;
+    if (parse_stat(buf, comm, &ticks, &start) < 0)
+        return;
+    res->read++;
+
+    uint64_t d_ticks = 0;
+    double dt = 0.0;
+    int baseline = 0;
+    if (old && old->start == start && ticks >= old->ticks) {
+        d_ticks = ticks - old->ticks;
+        dt = (uint32_t)(now_ms - old->t_ms) / 1e3;
+    }
+    else if (prev_list_ns &&
+             start >= prev_list_ns / 1000000 * clk_tck / 1000) {
+        /* started since /proc was last listed: all its CPU time is new */
+        d_ticks = ticks;
+        dt = now_ns / 1e9 - (double)start / clk_tck;
+    }
+    else {
+        baseline = 1;               // first sight: read again next scan
+    }
+
+    e->pid = pid;
+    e->pass = pass;
+    e->t_ms = now_ms;
+    e->idle = !baseline && d_ticks == 0;
+    e->start = start;
+    e->ticks = ticks;
+    n_cur++;
+
+    if (d_ticks == 0 || dt <= 0.0)
+        return;
+
+    struct attrib_task t = { .pid = pid };
+    memcpy(t.comm, comm, sizeof(t.comm));
+    t.cpus = (double)d_ticks / clk_tck / dt;
+    t.watts = t.cpus * watts_per_cpu;
+    res->watts += t.watts;
+    heap_offer(&t);
+}
+
+/* Revisit what the last scan knew; openat() finds the exited */
+static void revisit(uint64_t now, struct attrib_pass *res)
+{
+    const struct entry *prev = tables[(pass - 1) & 1];
+
+    for (unsigned i = 0; i < ATTRIB_SLOTS; i++) {
+        if (prev[i].pass != pass - 1)
+            continue;
+        res->tasks++;
+        visit(prev[i].pid, now, res);
+    }
+}
+
+static void list_proc(uint64_t now, struct attrib_pass *res)
+{
+    lseek(proc_fd, 0, SEEK_SET);
+    for (;;) {
+        long n = syscall(SYS_getdents64, proc_fd, dents, sizeof(dents));
+        if (n <= 0)
+            break;
+
+        for (long off = 0; off < n; ) {
+            const struct linux_dirent64 *d = (const void *)(dents + off);
+            off += d->d_reclen;
+
+            int pid = pid_of(d->d_name);
+            if (pid <= 0)
+                continue;
+            res->tasks++;
+            visit(pid, now, res);
+        }
+    }
+}
+
+void attrib_scan(double freq_ghz, double alpha)
+{
+    if (proc_fd < 0)
+        return;
+
+    uint64_t cpu0 = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t now = clock_ns(CLOCK_BOOTTIME);
+    struct attrib_pass res;
+
+    memset(&res, 0, sizeof(res));
+    pass++;
+    n_cur = 0;
+    n_heap = 0;
+    watts_per_cpu = alpha * freq_ghz / n_cpus;
+
+    if (prev_list_ns && pass % ATTRIB_LIST_EVERY) {
+        revisit(now, &res);
+    }
+    else {
+        list_proc(now, &res);
+        prev_list_ns = now;
+    }
+
+    qsort(heap, n_heap, sizeof(heap[0]), cmp_hotter);
+    memcpy(res.top, heap, n_heap * sizeof(heap[0]));
+    res.n_top = n_heap;
+    res.pass = pass;
+    res.span_s = prev_scan_ns ? (now - prev_scan_ns) / 1e9 : 0.0;
+    res.cost_ms = (clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu0) / 1e6;
+
+    last = res;
+    prev_scan_ns = now;
+}
+
+const struct attrib_pass *attrib_last(void)
+{
+    return &last;
+}
+
+void attrib_report(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+
+    if (proc_fd < 0) {
+        ctl_printf(r, "attribution disabled\n");
+        return;
+    }
+
+    ctl_printf(r, "scan=%llu span_s=%.2f tasks=%u read=%u untracked=%u "
+               "cost_ms=%.2f watts=%.2f\n",
+               (unsigned long long)last.pass, last.span_s, last.tasks,
+               last.read, last.untracked, last.cost_ms, last.watts);
+    ctl_printf(r, "%8s %-16s %8s %8s\n", "pid", "comm", "cpus", "watts");
+    for (unsigned i = 0; i < last.n_top; i++)
+        ctl_printf(r, "%8d %-16s %8.3f %8.2f\n", last.top[i].pid,
+                   last.top[i].comm, last.top[i].cpus, last.top[i].watts);
+}
+
+void attrib_close(void)
+{
+    if (proc_fd >= 0)
+        close(proc_fd);
+    proc_fd = -1;
+}
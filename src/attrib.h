@@ -0,0 +1,59 @@
+/*
+ * Per-process heat attribution
+ *
+ * Scans /proc/[pid]/stat once per interval and turns each process's
+ * CPU time since the previous scan into watts with the controller's
+ * power model (alpha * util * f), keeping the top ATTRIB_TOP
+ * contributors. Scanning and reporting both run on the main thread.
+ */
+
+#ifndef RC_ATTRIB_H
+#define RC_ATTRIB_H
+
+#include <stdint.h>
+
+#include "control.h"
+
+#define ATTRIB_TOP          16
+#define ATTRIB_SLOTS        32768   // tracked processes (power of two)
+#define ATTRIB_IDLE_EVERY   8       // idle processes are read every 8th scan
+#define ATTRIB_LIST_EVERY   4       // /proc is listed every 4th scan
+
+struct attrib_task {
+    int    pid;
+    char   comm[16];
+    double cpus;                    // CPUs kept busy over the interval
+    double watts;
+};
+
+struct attrib_pass {
+    uint64_t pass;
+    double   span_s;                // since the previous scan
+    double   cost_ms;               // CPU time the scan took
+    unsigned tasks;                 // processes known to the scan
+    unsigned read;                  // stat files read this scan
+    unsigned untracked;             // over ATTRIB_SLOTS, not attributed
+    double   watts;                 // sum over all processes read
+    unsigned n_top;
+    struct attrib_task top[ATTRIB_TOP];     // hottest first
+};
+
+/* Open the proc root (NULL for /proc); 0 or -1 */
+int attrib_open(const char *proc_root);
+
+/*
+ * One scan. Processes that were idle at their last read are read only
+ * every ATTRIB_IDLE_EVERY scans; their CPU time accumulates meanwhile.
+ * New processes are picked up every ATTRIB_LIST_EVERY scans.
+ */
+void attrib_scan(double freq_ghz, double alpha);
+
+/* Result of the last complete scan */
+const struct attrib_pass *attrib_last(void);
+
+/* Control command: top contributors of the last scan */
+void attrib_report(const char *args, struct ctl_reply *r);
+
+void attrib_close(void);
+
+#endif
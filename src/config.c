@@ -0,0 +1,145 @@
+/*
+ * The daemon's live parameter set
+ *
+ * Reclamation is quiescent-state based: each control-loop thread
+ * records the generation it last saw while holding no parameter
+ * pointer, and a retired set is freed once every thread has moved
+ * past the generation that replaced it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+#include "config.h"
+
+#define PARAMS_MAX_READERS  8
+#define PARAMS_MAX_RETIRED  32
+
+static _Atomic(const struct rc_params *) current = &params_builtin;
+static atomic_ullong current_gen;
+
+static atomic_ullong reader_gen[PARAMS_MAX_READERS];
+static atomic_int n_readers;
+
+static struct {
+    struct rc_params *p;
+    uint64_t gen;       // generation that replaced it
+} retired[PARAMS_MAX_RETIRED];
+static int n_retired = 0;
+
+const struct rc_params *params_get(void)
+{
+    return atomic_load_explicit(&current, memory_order_acquire);
+}
+
+/* Registration is implicit: a thread's slot is claimed on first use */
+static _Thread_local int reader_slot = -1;
+
+void params_quiescent(void)
+{
+    if (reader_slot < 0) {
+        int slot = atomic_fetch_add(&n_readers, 1);
+        if (slot >= PARAMS_MAX_READERS) {
+            fprintf(stderr, "config: too many parameter readers\n");
+            abort();
+        }
+        reader_slot = slot;
+    }
+
+    atomic_store_explicit(&reader_gen[reader_slot],
+                          atomic_load(&current_gen),
+                          memory_order_release);
+}
+
+static void reclaim(void)
+{
+    int readers = atomic_load(&n_readers);
+    if (readers > PARAMS_MAX_READERS)
+        readers = PARAMS_MAX_READERS;
+
+    uint64_t min_gen = UINT64_MAX;
+    for (int i = 0; i < readers; i++) {
+        uint64_t g = atomic_load_explicit(&reader_gen[i],
+                                          memory_order_acquire);
+        if (g < min_gen)
+            min_gen = g;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < n_retired; i++) {
+        if (retired[i].gen <= min_gen)
+            free(retired[i].p);
+        else
+            retired[kept++] = retired[i];
+    }
+    n_retired = kept;
+}
+
+static void publish(struct rc_params *p)
+{
+    reclaim();
+
+    p->generation = atomic_load(&current_gen) + 1;
+    const struct rc_params *old = atomic_exchange(&current, p);
+    atomic_store(&current_gen, p->generation);
+
+    if (old != &params_builtin) {
+        if (n_retired < PARAMS_MAX_RETIRED) {
+            retired[n_retired].p = (struct rc_params *)old;
+            retired[n_retired].gen = p->generation;
+            n_retired++;
+        }
+        /* else: readers are stuck; leaking beats a use-after-free */
+    }
+}
+
+int config_reload(const char *path, int missing_ok)
+{
+    char err[256];
+    struct rc_params *p = malloc(sizeof(*p));
+    if (!p)
+        return -1;
+
+    errno = 0;
+    if (params_parse(path, p, err, sizeof(err)) < 0) {
+        if (!(missing_ok && errno == ENOENT)) {
+            fprintf(stderr, "config: %s — keeping current parameters\n",
+                    err);
+            free(p);
+            return -1;
+        }
+        params_defaults(p);
+    }
+
+    publish(p);
+    return 0;
+}
+
+int params_publish(const struct rc_params *src)
+{
+    char err[256];
+    if (params_validate(src, err, sizeof(err)) < 0)
+        return -1;
+
+    struct rc_params *p = malloc(sizeof(*p));
+    if (!p)
+        return -1;
+    *p = *src;
+
+    publish(p);
+    return 0;
+}
+
+void params_shutdown(void)
+{
+    for (int i = 0; i < n_retired; i++)
+        free(retired[i].p);
+    n_retired = 0;
+
+    const struct rc_params *p = atomic_exchange(&current, &params_builtin);
+    if (p != &params_builtin)
+        free((struct rc_params *)p);
+}
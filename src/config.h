@@ -0,0 +1,37 @@
+/*
+ * The daemon's live parameter set
+ *
+ * The control loop reads the current set through params_get(); a
+ * reload parses a new struct (params.h) off the hot path and
+ * publishes it with a single pointer swap, so a stage sees either the
+ * old or the new configuration, never a mix.
+ */
+
+#ifndef RC_CONFIG_H
+#define RC_CONFIG_H
+
+#include "params.h"
+
+/* Current parameters; valid until the caller's next params_quiescent() */
+const struct rc_params *params_get(void);
+
+/*
+ * Control-loop threads call this once at start (which registers them)
+ * and then between records, when they hold no pointer from
+ * params_get(). Lets retired parameter sets be freed.
+ */
+void params_quiescent(void);
+
+/*
+ * Parse `path` and publish it; missing file means defaults if
+ * `missing_ok`. Called from the main thread only.
+ */
+int config_reload(const char *path, int missing_ok);
+
+/* Publish a copy of `p` as config_reload() would; -1 if invalid */
+int params_publish(const struct rc_params *p);
+
+/* Free every retired parameter set; only once readers are stopped */
+void params_shutdown(void);
+
+#endif
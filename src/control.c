@@ -0,0 +1,324 @@
+/*
+ * Unix-domain control socket
+ *
+ * Clients are served from the main event loop, which also handles
+ * SIGTERM, so nothing here may block: a client's fd stays
+ * non-blocking, its command is gathered across reads until a newline
+ * or EOF, and its reply is sent as far as the socket takes it and
+ * finished on the next writable event. A client that stops reading
+ * only holds its own slot, until a later connection finds it older
+ * than CTL_CLIENT_TIMEOUT_S.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "control.h"
+
+struct ctl_command {
+    const char *name;
+    const char *help;
+    ctl_handler fn;
+};
+
+static struct ctl_command commands[CTL_MAX_COMMANDS];
+static int n_commands = 0;
+
+struct ctl_client {
+    int used;
+    int fd;
+    time_t since;               // CLOCK_MONOTONIC s, at accept
+    size_t in_len;
+    char in[256];
+    int replying;               // command run, reply being sent
+    size_t sent;
+    struct ctl_reply reply;
+};
+
+/* Touched from the event loop thread only */
+static struct ctl_client clients[CTL_MAX_CLIENTS];
+
+void ctl_printf(struct ctl_reply *r, const char *fmt, ...)
+{
+    if (r->len >= sizeof(r->buf) - 1)
+        return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(r->buf + r->len, sizeof(r->buf) - r->len, fmt, ap);
+    va_end(ap);
+
+    if (n < 0)
+        return;
+    r->len += (size_t)n;
+    if (r->len > sizeof(r->buf) - 1)
+        r->len = sizeof(r->buf) - 1;
+}
+
+int control_register(const char *name, const char *help, ctl_handler fn)
+{
+    if (n_commands >= CTL_MAX_COMMANDS)
+        return -1;
+
+    commands[n_commands].name = name;
+    commands[n_commands].help = help;
+    commands[n_commands].fn = fn;
+    n_commands++;
+
+    return 0;
+}
+
+static void cmd_help(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+    for (int i = 0; i < n_commands; i++)
+        ctl_printf(r, "%-10s %s\n", commands[i].name, commands[i].help);
+}
+
+int control_listen(const char *path)
+{
+    if (n_commands == 0 || strcmp(commands[0].name, "help") != 0) {
+        memmove(&commands[1], &commands[0], n_commands * sizeof(commands[0]));
+        commands[0] = (struct ctl_command){ "help", "list commands",
+                                            cmd_help };
+        n_commands++;
+    }
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, path);
+
+    char dir[sizeof(addr.sun_path)];
+    strcpy(dir, path);
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(fd, 8) < 0) {
+        fprintf(stderr, "control: cannot listen on %s: %s\n",
+                path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    chmod(path, 0600);
+
+    return fd;
+}
+
+static time_t mono_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+static void client_free(struct ctl_client *c)
+{
+    c->used = 0;
+    c->fd = -1;
+}
+
+/* Close clients that have had their chance */
+static void expire_clients(time_t now)
+{
+    for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+        struct ctl_client *c = &clients[i];
+        if (c->used && now - c->since >= CTL_CLIENT_TIMEOUT_S) {
+            close(c->fd);       // also leaves the epoll set
+            client_free(c);
+        }
+    }
+}
+
+int control_accept(int lfd)
+{
+    time_t now = mono_s();
+    struct ctl_client *c = NULL;
+
+    expire_clients(now);
+    for (int i = 0; i < CTL_MAX_CLIENTS && !c; i++)
+        if (!clients[i].used)
+            c = &clients[i];
+
+    int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (!c) {
+        /* busy: turn it away rather than leave the listener readable */
+        close(fd);
+        return -1;
+    }
+
+    memset(c, 0, offsetof(struct ctl_client, reply));
+    c->used = 1;
+    c->fd = fd;
+    c->since = now;
+    return fd;
+}
+
+static struct ctl_client *find_client(int fd)
+{
+    for (int i = 0; i < CTL_MAX_CLIENTS; i++)
+        if (clients[i].used && clients[i].fd == fd)
+            return &clients[i];
+    return NULL;
+}
+
+static void send_all(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+static void dispatch(struct ctl_client *c)
+{
+    char *line = c->in;
+
+    c->in[c->in_len] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+
+    char *args = line + strcspn(line, " ");
+    if (*args)
+        *args++ = '\0';
+
+    c->reply.len = 0;
+    int found = 0;
+    for (int i = 0; i < n_commands; i++) {
+        if (strcmp(commands[i].name, line) == 0) {
+            commands[i].fn(args, &c->reply);
+            found = 1;
+            break;
+        }
+    }
+    if (!found)
+        ctl_printf(&c->reply, "unknown command '%s' (try 'help')\n", line);
+
+    c->replying = 1;
+    c->sent = 0;
+}
+
+/* 1 once a whole line (or EOF) is in, 0 for more to come, -1 error */
+static int read_command(struct ctl_client *c)
+{
+    for (;;) {
+        if (c->in_len == sizeof(c->in) - 1)
+            return 1;           // overlong: run what fits
+
+        ssize_t n = recv(c->fd, c->in + c->in_len,
+                         sizeof(c->in) - 1 - c->in_len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        if (n == 0)
+            return c->in_len > 0 ? 1 : -1;
+
+        int nl = memchr(c->in + c->in_len, '\n', (size_t)n) != NULL;
+        c->in_len += (size_t)n;
+        if (nl)
+            return 1;
+    }
+}
+
+/* 1 when the reply is all out, 0 for more to come, -1 error */
+static int send_reply(struct ctl_client *c)
+{
+    while (c->sent < c->reply.len) {
+        ssize_t n = send(c->fd, c->reply.buf + c->sent,
+                         c->reply.len - c->sent,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+        c->sent += (size_t)n;
+    }
+    return 1;
+}
+
+int control_serve(int cfd)
+{
+    struct ctl_client *c = find_client(cfd);
+    if (!c)
+        return 0;
+
+    if (!c->replying) {
+        int rc = read_command(c);
+        if (rc == 0)
+            return 1;
+        if (rc < 0) {
+            client_free(c);
+            return 0;
+        }
+        dispatch(c);
+    }
+
+    if (send_reply(c) == 0)
+        return 1;
+
+    client_free(c);
+    return 0;
+}
+
+void control_close(int lfd, const char *path)
+{
+    if (lfd < 0)
+        return;
+    close(lfd);
+    unlink(path);
+}
+
+int control_query(const char *path, const char *cmd)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "cannot connect to %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    char line[256];
+    int len = snprintf(line, sizeof(line), "%s\n", cmd);
+    send_all(fd, line, (size_t)len);
+
+    char buf[4096];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+        fwrite(buf, 1, (size_t)n, stdout);
+
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Unix-domain control socket
+ *
+ * Line-oriented: a client connects, sends one command line, reads the
+ * reply until EOF. Commands are registered by the modules that own the
+ * state they report.
+ */
+
+#ifndef RC_CONTROL_H
+#define RC_CONTROL_H
+
+#include <stddef.h>
+
+#define CONTROL_SOCKET_PATH "/run/rc_sched/control.sock"
+#define CTL_REPLY_MAX       65536
+#define CTL_MAX_COMMANDS    32
+#define CTL_MAX_CLIENTS     4       // served at once, more are refused
+#define CTL_CLIENT_TIMEOUT_S 5      // then a stalled client is dropped
+
+struct ctl_reply {
+    size_t len;
+    char buf[CTL_REPLY_MAX];
+};
+
+/* `args` is the rest of the command line after the name (may be "") */
+typedef void (*ctl_handler)(const char *args, struct ctl_reply *r);
+
+/* Append formatted text to a reply; silently truncates when full */
+void ctl_printf(struct ctl_reply *r, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+int control_register(const char *name, const char *help, ctl_handler fn);
+
+/* Bind and listen; returns a non-blocking listening fd or -1 */
+int control_listen(const char *path);
+
+/*
+ * Accept one client; returns a non-blocking fd or -1. Closes clients
+ * older than CTL_CLIENT_TIMEOUT_S first, and turns the new one away
+ * when all CTL_MAX_CLIENTS slots are still taken.
+ */
+int control_accept(int lfd);
+
+/*
+ * Make progress on a client without blocking: gather its command line,
+ * run it, send as much of the reply as the socket takes. Call on every
+ * readable or writable event (the fd suits edge-triggered polling for
+ * both). Returns 1 while the client needs more events, 0 when done
+ * (the caller closes the fd).
+ */
+int control_serve(int cfd);
+
+void control_close(int lfd, const char *path);
+
+/* Client side: send `cmd` to the daemon and copy the reply to stdout */
+int control_query(const char *path, const char *cmd);
+
+#endif
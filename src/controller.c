@@ -0,0 +1,653 @@
+/*
+ * rc_sched's controller: librcthermal instances on the host
+ *
+ * One controller per CPU package, each reading its package's thermal
+ * zone and capping only that package's cpufreq policies; a single
+ * controller on zone 0 and cpu0 when no topology is visible. On hybrid
+ * parts only the performance cores' policies are capped unless told
+ * otherwise. Each package's thresholds follow its zone's trip points.
+ * The process-wide fans, cgroup clamps, background steering and idle
+ * injection follow whichever package asks for most. Every decision is
+ * published to telemetry, the headroom page, the recorder, the
+ * in-process history and the console.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "controller.h"
+#include "config.h"
+#include "topology.h"
+#include "trips.h"
+#include "uclamp.h"
+#include "steer.h"
+#include "fan.h"
+#include "idle_inject.h"
+#include "seqlock.h"
+#include "telemetry.h"
+#include "headroom.h"
+#include "recorder.h"
+#include "history.h"
+#include "msglog.h"
+
+_Static_assert(RCT_LEVEL_CAPPED == RC_TELEM_MIT_CAPPED &&
+               RCT_LEVEL_IDLE == RC_TELEM_MIT_IDLE, "mitigation levels");
+_Static_assert(SAMPLE_MAX_PKG <= RC_TELEM_MAX_ZONES, "telemetry zones");
+
+/* =======================
+   GLOBAL STATE
+   ======================= */
+static struct topology topo;
+static struct sysfs_ctx host_sysfs[SAMPLE_MAX_PKG] = { SYSFS_CTX_INIT };
+static struct rct_controller ctl[SAMPLE_MAX_PKG];
+static int ctl_zone[SAMPLE_MAX_PKG] = { -1 };  // -1: not a sysfs zone
+static int n_ctl = 1;
+static int configured = 0;
+static int uclamp_only = 0;        // leave scaling_max_freq alone
+static int cap_efficient = 0;      // hybrid: cap E-core policies too
+static double summary_s = 1.0;     // console summary interval, 0 = off
+static int quiet = 0;              // no decision messages (sweeps)
+
+/* =======================
+   Trip point thresholds
+   ======================= */
+
+/*
+ * Each zone's trips, re-read by the main thread and handed to the
+ * actuator under a seqlock. The actuator keeps every package's
+ * effective parameter set and rebuilds it when either the trips or
+ * the published parameters change.
+ */
+static struct {
+    atomic_uint seq;
+    struct trips t[SAMPLE_MAX_PKG];
+} trips;
+
+static struct {
+    unsigned trips_seq;
+    uint64_t generation;
+    int valid;
+    struct rc_params p[SAMPLE_MAX_PKG];
+} eff;
+
+static const struct rc_params *pkg_params(const struct rc_params *p, int k)
+{
+    unsigned seq = atomic_load_explicit(&trips.seq, memory_order_acquire);
+
+    if (!eff.valid || eff.generation != p->generation ||
+        eff.trips_seq != seq) {
+        struct trips t[SAMPLE_MAX_PKG];
+        do {
+            seq = seq_read_begin(&trips.seq);
+            memcpy(t, trips.t, sizeof(t));
+        } while (seq_read_retry(&trips.seq, seq));
+
+        for (int i = 0; i < n_ctl; i++)
+            trips_thresholds(p, &t[i], &eff.p[i]);
+        eff.trips_seq = seq;
+        eff.generation = p->generation;
+        eff.valid = 1;
+    }
+    return &eff.p[k];
+}
+
+/* =======================
+   Sensor health
+   ======================= */
+
+/* Each controller's health counters, published by the sampler */
+static struct {
+    atomic_uint seq;
+    struct health_stats st[SAMPLE_MAX_PKG];
+} health;
+
+static void health_publish(void)
+{
+    seq_write_begin(&health.seq);
+    for (int k = 0; k < n_ctl; k++)
+        health.st[k] = ctl[k].health.st;
+    seq_write_end(&health.seq);
+}
+
+/* =======================
+   Host actuators
+   ======================= */
+
+/* What each package's controller asked for (actuator thread only) */
+static double clamp_over[SAMPLE_MAX_PKG];
+static int clamped[SAMPLE_MAX_PKG];
+static double cool_level[SAMPLE_MAX_PKG];
+
+static int pkg_of(void *ctx)
+{
+    return (int)(intptr_t)ctx;
+}
+
+static void apply_clamp(void)
+{
+    int any = 0;
+    double over = 0.0;
+
+    for (int k = 0; k < n_ctl; k++) {
+        if (!clamped[k])
+            continue;
+        if (!any || clamp_over[k] > over)
+            over = clamp_over[k];
+        any = 1;
+    }
+
+    if (any) {
+        uclamp_apply(over);
+        steer_apply();
+    }
+    else {
+        uclamp_restore();
+        steer_restore();
+    }
+}
+
+static void host_clamp(void *ctx, double overshoot)
+{
+    clamp_over[pkg_of(ctx)] = overshoot;
+    clamped[pkg_of(ctx)] = 1;
+    apply_clamp();
+}
+
+static void host_unclamp(void *ctx)
+{
+    clamped[pkg_of(ctx)] = 0;
+    apply_clamp();
+}
+
+/* Each package injects on its own CPUs */
+static void host_idle_set(void *ctx, double frac)
+{
+    idle_inject_set(pkg_of(ctx), frac);
+}
+
+static int host_idle_pct(void *ctx)
+{
+    return idle_inject_pct(pkg_of(ctx));
+}
+
+static void host_cool_set(void *ctx, double level)
+{
+    double max = 0.0;
+
+    cool_level[pkg_of(ctx)] = level;
+    for (int k = 0; k < n_ctl; k++)
+        if (cool_level[k] > max)
+            max = cool_level[k];
+    fan_set(max);
+}
+
+/* What the fans are really doing, whoever asked */
+static double host_cool_level(void *ctx)
+{
+    (void)ctx;
+    return fan_level();
+}
+
+static const struct rct_actuator_ops host_actuators = {
+    .clamp    = host_clamp,
+    .unclamp  = host_unclamp,
+    .idle_set = host_idle_set,
+    .idle_pct = host_idle_pct,
+};
+
+static const struct rct_actuator_ops host_fan_actuators = {
+    .clamp      = host_clamp,
+    .unclamp    = host_unclamp,
+    .idle_set   = host_idle_set,
+    .idle_pct   = host_idle_pct,
+    .cool_set   = host_cool_set,
+    .cool_level = host_cool_level,
+};
+
+/* Decision messages; on a virtual clock they carry its time */
+static void note(void *arg, double now, const char *msg)
+{
+    char stamp[32] = "", pkg[32] = "";
+
+    if (quiet)
+        return;
+    if (ctl[0].plat.ops != &sysfs_platform)
+        snprintf(stamp, sizeof(stamp), "[%12.3f] ", now);
+    if (n_ctl > 1)
+        snprintf(pkg, sizeof(pkg), "package %d: ",
+                 topo.package_id[pkg_of(arg)]);
+    msglog_printf("%s%s%s\n", stamp, pkg, msg);
+}
+
+static void bind_one(int k, const struct platform_ops *ops, void *ctx)
+{
+    struct platform plat = { ops, ctx };
+    struct rct_actuators act = {
+        fan_count() > 0 ? &host_fan_actuators : &host_actuators,
+        (void *)(intptr_t)k
+    };
+
+    rct_init(&ctl[k], &plat, &act);
+    ctl[k].clamp_only = uclamp_only;
+    ctl[k].note = note;
+    ctl[k].note_arg = (void *)(intptr_t)k;
+    clamped[k] = 0;
+    cool_level[k] = 0.0;
+}
+
+static void bind(const struct platform_ops *ops, void *ctx)
+{
+    n_ctl = 1;
+    ctl_zone[0] = -1;
+    bind_one(0, ops, ctx);
+    configured = 1;
+
+    seq_write_begin(&trips.seq);
+    memset(trips.t, 0, sizeof(trips.t));
+    seq_write_end(&trips.seq);
+}
+
+/*
+ * A controller per package on its own zone (zone 0 if the package has
+ * none mapped) and policies (its first cpu's if cpufreq shows none).
+ * The heat of a hybrid package is almost all the performance cores',
+ * so their policies alone are capped when there are any.
+ */
+static void bind_packages(const char *root)
+{
+    int n = topo.n_packages < SAMPLE_MAX_PKG ? topo.n_packages :
+                                               SAMPLE_MAX_PKG;
+    int type = topo.hybrid && !cap_efficient ? TOPO_CORE_PERF :
+                                               TOPO_CORE_UNIFORM;
+
+    for (int k = 0; k < n; k++) {
+        struct sysfs_ctx *s = &host_sysfs[k];
+        int cpus[SYSFS_MAX_POLICIES];
+        int n_pol = topology_policies_of(&topo, k, type, cpus,
+                                         SYSFS_MAX_POLICIES);
+        int first = 0;
+
+        if (n_pol == 0)
+            n_pol = topology_policies(&topo, k, cpus, SYSFS_MAX_POLICIES);
+
+        if (n_pol == 0) {
+            while (first < topo.n_cpus && topo.pkg[first] != k)
+                first++;
+            cpus[0] = first;
+        }
+
+        for (int cpu = 0; cpu < topo.n_cpus; cpu++)
+            if (topo.pkg[cpu] == k)
+                idle_inject_set_package(cpu, k);
+
+        ctl_zone[k] = topo.pkg_zone[k] >= 0 ? topo.pkg_zone[k] : 0;
+        sysfs_init(s, root, ctl_zone[k], cpus[0]);
+        for (int i = 1; i < n_pol; i++)
+            sysfs_add_policy(s, cpus[i]);
+
+        bind_one(k, &sysfs_platform, s);
+    }
+    n_ctl = n;
+    configured = 1;
+}
+
+static void ensure_bound(void)
+{
+    if (!configured)
+        bind(&sysfs_platform, &host_sysfs[0]);
+}
+
+/* =======================
+   Control stages
+   ======================= */
+
+/*
+ * Last decision (written by the actuator only). Kept in-process under
+ * a seqlock for the status command and mirrored to shared memory.
+ */
+static struct {
+    atomic_uint seq;
+    struct rc_telem_data d;
+} last;
+
+/* Console summary over the last summary_s seconds (actuator only) */
+static struct {
+    uint64_t start_ns;
+    unsigned n, invalid;
+    double t_min, t_max, t_sum;
+} summ;
+
+static void summary_add(const struct rc_telem_data *d,
+                        const struct sample_rec *r)
+{
+    if (summary_s <= 0)
+        return;
+
+    if (summ.n == 0 && summ.invalid == 0)
+        summ.start_ns = d->t_sample_ns;
+
+    if (d->valid) {
+        double T = r->T_curr;
+        if (summ.n == 0 || T < summ.t_min) summ.t_min = T;
+        if (summ.n == 0 || T > summ.t_max) summ.t_max = T;
+        summ.t_sum += T;
+        summ.n++;
+    }
+    else {
+        summ.invalid++;
+    }
+
+    if (d->t_sample_ns - summ.start_ns < (uint64_t)(summary_s * 1e9))
+        return;
+
+    if (summ.n > 0) {
+        char fan[32] = "", mit[80] = "", fail[32] = "";
+
+        if (fan_level() > 0.0)
+            snprintf(fan, sizeof(fan), " | fan=%.0f%%",
+                     fan_level() * 100.0);
+        if (d->mitigation_level != RC_TELEM_MIT_NONE)
+            snprintf(mit, sizeof(mit), " | cap=%d kHz uclamp=%.0f%% "
+                     "idle=%d%%", d->cap_khz, d->uclamp_pct, d->idle_pct);
+        if (summ.invalid)
+            snprintf(fail, sizeof(fail), " | %u failed reads",
+                     summ.invalid);
+        msglog_printf("T=%.2f..%.2f (mean %.2f)°C | T_pred=%.2f°C "
+                      "| f=%.2f GHz | P=%.2f W%s%s%s\n",
+                      summ.t_min, summ.t_max, summ.t_sum / summ.n,
+                      r->T_pred, d->freq_ghz, d->power_w, fan, mit, fail);
+    }
+    memset(&summ, 0, sizeof(summ));
+}
+
+/* =======================
+   Per-package samples
+   ======================= */
+static void pkg_load(struct sample_rec *dst, const struct pkg_sample *ps)
+{
+    dst->T_curr = ps->T_curr;
+    dst->freq = ps->freq;
+    dst->util = ps->util;
+    dst->power = ps->power;
+    dst->T_pred = ps->T_pred;
+    dst->cooling = ps->cooling;
+    dst->valid = ps->valid;
+}
+
+static void pkg_store(struct pkg_sample *ps, const struct sample_rec *src)
+{
+    ps->T_curr = src->T_curr;
+    ps->freq = src->freq;
+    ps->util = src->util;
+    ps->power = src->power;
+    ps->T_pred = src->T_pred;
+    ps->cooling = src->cooling;
+    ps->valid = src->valid;
+}
+
+/* The package predicted hottest, preferring valid ones */
+static unsigned hottest(const struct sample_rec *r)
+{
+    unsigned hot = 0;
+
+    for (unsigned k = 1; k < r->n_pkg; k++) {
+        const struct pkg_sample *a = &r->pkg[k], *b = &r->pkg[hot];
+        if (a->valid > b->valid || (a->valid == b->valid &&
+                                    a->T_pred > b->T_pred))
+            hot = k;
+    }
+    return hot;
+}
+
+void sample_sensors(struct sample_rec *r)
+{
+    const struct rc_params *p = params_get();
+
+    ensure_bound();
+
+    if (n_ctl == 1) {
+        rct_sample(&ctl[0], p, r);
+        health_publish();
+        return;
+    }
+
+    r->n_pkg = n_ctl;
+    for (int k = 0; k < n_ctl; k++) {
+        struct sample_rec s = { 0 };
+        rct_sample(&ctl[k], p, &s);
+        pkg_store(&r->pkg[k], &s);
+    }
+    pkg_load(r, &r->pkg[0]);
+    health_publish();
+}
+
+void model_step(struct sample_rec *r)
+{
+    const struct rc_params *p = params_get();
+
+    if (!r->n_pkg) {
+        rct_model(p, r);
+        return;
+    }
+
+    for (unsigned k = 0; k < r->n_pkg; k++) {
+        struct sample_rec s = { 0 };
+        pkg_load(&s, &r->pkg[k]);
+        rct_model(p, &s);
+        pkg_store(&r->pkg[k], &s);
+    }
+    pkg_load(r, &r->pkg[hottest(r)]);
+}
+
+void actuate(const struct sample_rec *r)
+{
+    const struct rc_params *p = params_get();
+    int lead = 0, hot = 0;
+
+    ensure_bound();
+
+    if (!r->n_pkg) {
+        rct_actuate(&ctl[0], pkg_params(p, 0), r);
+    }
+    else {
+        lead = hot = (int)hottest(r);
+        for (int k = 0; k < (int)r->n_pkg && k < n_ctl; k++) {
+            struct sample_rec s = { 0 };
+            pkg_load(&s, &r->pkg[k]);
+            rct_actuate(&ctl[k], pkg_params(p, k), &s);
+            if (rct_level(&ctl[k]) > rct_level(&ctl[lead]))
+                lead = k;
+        }
+    }
+
+    struct rc_telem_data d;
+    memset(&d, 0, sizeof(d));
+
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+
+    /* Scalars are zone `hot`'s package; the cap is the most mitigated */
+    d.sample_seq = r->seq;
+    d.t_sample_ns = r->t_sample_ns;
+    d.t_wall_ns = (int64_t)wall.tv_sec * 1000000000LL + wall.tv_nsec;
+    d.valid = (uint32_t)r->valid;
+    d.mitigation_level = rct_level(&ctl[lead]);
+    d.freq_ghz = r->freq;
+    d.util = r->util;
+    d.power_w = r->power;
+    d.cap_khz = ctl[lead].applied_max_freq;
+    d.original_khz = ctl[lead].applied_max_freq > 0 ?
+                         ctl[lead].original_max_freq : -1;
+    d.uclamp_pct = uclamp_current_pct();
+    d.idle_pct = rct_idle_pct(&ctl[lead]);
+    if (!r->n_pkg) {
+        d.n_zones = 1;
+        d.zones[0].temp_c = r->T_curr;
+        d.zones[0].pred_c = r->T_pred;
+    }
+    else {
+        d.n_zones = r->n_pkg;
+        for (unsigned k = 0; k < r->n_pkg; k++) {
+            d.zones[k].temp_c = r->pkg[k].T_curr;
+            d.zones[k].pred_c = r->pkg[k].T_pred;
+        }
+    }
+
+    seq_write_begin(&last.seq);
+    last.d = d;
+    seq_write_end(&last.seq);
+
+    telemetry_publish(&d);
+    headroom_publish(r, pkg_params(p, hot), d.mitigation_level);
+    recorder_append(&d, (unsigned)hot);
+    history_append(&d);
+    summary_add(&d, r);
+}
+
+const struct pipeline_ops controller_ops = {
+    .sample  = sample_sensors,
+    .model   = model_step,
+    .actuate = actuate,
+};
+
+void controller_configure(int only, double interval_s)
+{
+    uclamp_only = only;
+    summary_s = interval_s;
+    for (int k = 0; k < n_ctl; k++)
+        ctl[k].clamp_only = only;
+}
+
+int controller_bind_host(const char *root)
+{
+    if (topology_probe(&topo, root) < 0) {
+        sysfs_init(&host_sysfs[0], root, 0, 0);
+        bind(&sysfs_platform, &host_sysfs[0]);
+        ctl_zone[0] = 0;
+        controller_refresh_trips();
+        return 0;
+    }
+
+    bind_packages(root);
+    controller_refresh_trips();
+
+    char eff[STEER_CPULIST_MAX];
+    if (topo.hybrid && topology_cpulist(&topo, TOPO_CORE_EFF, eff,
+                                        sizeof(eff)) > 0)
+        steer_set_cpus(eff);
+    return n_ctl;
+}
+
+int controller_refresh_trips(void)
+{
+    struct trips t[SAMPLE_MAX_PKG] = { { 0 } };
+    int changed = 0;
+
+    for (int k = 0; k < n_ctl; k++)
+        if (ctl_zone[k] >= 0)
+            trips_read(host_sysfs[k].root, ctl_zone[k], &t[k]);
+
+    for (int k = 0; k < n_ctl; k++) {
+        if (memcmp(&t[k], &trips.t[k], sizeof(t[k])) == 0)
+            continue;
+        changed++;
+        if (quiet)
+            continue;
+        printf("thermal_zone%d: trip points passive %.1f°C, "
+               "critical %.1f°C\n",
+               ctl_zone[k], t[k].passive, t[k].critical);
+
+        /* once per new trip set: say when it cannot be used as given */
+        const struct rc_params *p = params_get();
+        struct rc_params e;
+        int rc = trips_thresholds(p, &t[k], &e);
+        if (rc == 2)
+            printf("thermal_zone%d: trips closer than the offsets, "
+                   "t_high %.1f°C, t_critical clamped to %.1f°C\n",
+                   ctl_zone[k], e.t_high, e.t_critical);
+        else if (rc == 0 && p->trip_auto &&
+                 (t[k].passive > 0.0 || t[k].critical > 0.0))
+            printf("thermal_zone%d: trips unusable, keeping the fixed "
+                   "thresholds\n", ctl_zone[k]);
+    }
+    if (!changed)
+        return 0;
+
+    seq_write_begin(&trips.seq);
+    memcpy(trips.t, t, sizeof(t));
+    seq_write_end(&trips.seq);
+    return changed;
+}
+
+void controller_trips(int k, struct trips *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (k >= 0 && k < n_ctl)
+        *out = trips.t[k];
+}
+
+int controller_health(int k, struct health_stats *out, double *age_s)
+{
+    unsigned seq;
+
+    if (k < 0 || k >= n_ctl)
+        return -1;
+
+    do {
+        seq = seq_read_begin(&health.seq);
+        *out = health.st[k];
+    } while (seq_read_retry(&health.seq, seq));
+
+    const struct platform *plat = &ctl[k].plat;
+    *age_s = out->last_good_t < 0.0 ? -1.0 :
+             plat->ops->now(plat->ctx) - out->last_good_t;
+    return 0;
+}
+
+void controller_cap_efficient(int on)
+{
+    cap_efficient = on;
+}
+
+const struct topology *controller_topology(void)
+{
+    return &topo;
+}
+
+void controller_platform(const struct platform_ops *ops, void *ctx)
+{
+    if (!ops) {
+        ops = &sysfs_platform;
+        ctx = &host_sysfs[0];
+        sysfs_init(ctx, NULL, 0, 0);
+    }
+    bind(ops, ctx);
+}
+
+void controller_snapshot(struct rc_telem_data *out)
+{
+    unsigned seq;
+
+    do {
+        seq = seq_read_begin(&last.seq);
+        *out = last.d;
+    } while (seq_read_retry(&last.seq, seq));
+}
+
+void controller_quiet(int on)
+{
+    quiet = on;
+}
+
+void controller_reset(void)
+{
+    ensure_bound();
+    for (int k = 0; k < n_ctl; k++) {
+        rct_reset(&ctl[k]);
+        clamped[k] = 0;
+        cool_level[k] = 0.0;
+    }
+    memset(&summ, 0, sizeof(summ));
+}
@@ -0,0 +1,82 @@
+/*
+ * rc_sched's controller: one librcthermal instance on the host
+ *
+ * sample_sensors -> model_step -> actuate is one control decision.
+ * The pipeline runs each stage on its own thread; replay and the
+ * benchmarks call the same three functions serially.
+ */
+
+#ifndef RC_CONTROLLER_H
+#define RC_CONTROLLER_H
+
+#include "rcthermal.h"
+#include "topology.h"
+#include "trips.h"
+#include "pipeline.h"
+#include "rc_telemetry.h"
+
+/* The three stages, for pipeline_start() and replay_run() */
+extern const struct pipeline_ops controller_ops;
+
+/*
+ * uclamp_only: mitigate with cgroup clamps and leave scaling_max_freq
+ * alone. summary_s: console summary interval, 0 disables.
+ */
+void controller_configure(int uclamp_only, double summary_s);
+
+/*
+ * Probe the CPU topology and run one controller per package on the
+ * sysfs under `root` (NULL: the host's); one on zone 0 and cpu0 if no
+ * topology is visible. Returns the number of package controllers, 0
+ * for the fallback.
+ */
+int controller_bind_host(const char *root);
+
+/*
+ * Hybrid parts: cap efficient-core policies as well as performance
+ * ones. Takes effect at the next controller_bind_host().
+ */
+void controller_cap_efficient(int on);
+
+/*
+ * Re-read the trip points of every controller's zone (main thread).
+ * Changed trips are picked up by the actuator at its next decision.
+ * Returns how many zones changed.
+ */
+int controller_refresh_trips(void);
+
+/* Trips of controller k as last read; zeroed if unknown */
+void controller_trips(int k, struct trips *out);
+
+/*
+ * Sensor health of controller k and the age of its last good reading
+ * (-1 if none). 0, or -1 if there is no such controller.
+ */
+int controller_health(int k, struct health_stats *out, double *age_s);
+
+/* Snapshot taken by controller_bind_host() */
+const struct topology *controller_topology(void);
+
+/*
+ * Run against another backend (replay, simulation, a fake sysfs
+ * tree); NULL goes back to the host's sysfs. Resets the controller.
+ */
+void controller_platform(const struct platform_ops *ops, void *ctx);
+
+/* Suppress decision messages */
+void controller_quiet(int on);
+
+/*
+ * Forget mitigation state between independent runs (simulation).
+ * Does not touch the platform: restore limits first.
+ */
+void controller_reset(void);
+
+/* Last decision as published to telemetry */
+void controller_snapshot(struct rc_telem_data *out);
+
+void sample_sensors(struct sample_rec *r);
+void model_step(struct sample_rec *r);
+void actuate(const struct sample_rec *r);
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ * Fan actuator: thermal cooling devices and hwmon PWM outputs
+ *
+ * Cooling devices take cur_state 0..max_state. A hwmon pwmN takes
+ * 0..255 and is only obeyed in manual mode (pwmN_enable = 1), which is
+ * set on the first change. pwmN is journaled before pwmN_enable so a
+ * restore puts the duty cycle back before handing control back to the
+ * firmware. Writes go through the journal, which keeps the originals.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include "fan.h"
+#include "journal.h"
+
+#define CDEV_DIR        "/sys/class/thermal"
+#define PWM_MAX         255
+
+struct fan_dev {
+    char path[256];         // cur_state or pwmN
+    char enable[256];       // pwmN_enable, "" if none
+    int max;
+    int base;               // value found when escalation started
+    int applied;            // -1 when untouched
+};
+
+static struct fan_dev devs[FAN_MAX_DEVICES];
+static int n_devs = 0;
+static atomic_int level_pm;         // applied level, per mille
+
+static int read_int_file(const char *path, int *val)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    int ok = fscanf(fp, "%d", val) == 1;
+    fclose(fp);
+
+    return ok ? 0 : -1;
+}
+
+static struct fan_dev *new_dev(const char *path)
+{
+    if (n_devs >= FAN_MAX_DEVICES) {
+        fprintf(stderr, "fan: too many devices (max %d)\n", FAN_MAX_DEVICES);
+        return NULL;
+    }
+
+    for (int i = 0; i < n_devs; i++)
+        if (strcmp(devs[i].path, path) == 0)
+            return NULL;
+
+    struct fan_dev *f = &devs[n_devs];
+    memset(f, 0, sizeof(*f));
+    snprintf(f->path, sizeof(f->path), "%s", path);
+    f->applied = -1;
+    return f;
+}
+
+static int add_cdev(const char *dir)
+{
+    char path[256];
+    int max, cur;
+
+    snprintf(path, sizeof(path), "%s/max_state", dir);
+    if (read_int_file(path, &max) < 0 || max <= 0)
+        return -1;
+
+    snprintf(path, sizeof(path), "%s/cur_state", dir);
+    if (read_int_file(path, &cur) < 0)
+        return -1;
+
+    struct fan_dev *f = new_dev(path);
+    if (!f)
+        return -1;
+    f->max = max;
+    n_devs++;
+    return 0;
+}
+
+static int add_pwm(const char *file)
+{
+    char enable[256];
+    int cur;
+
+    if (read_int_file(file, &cur) < 0)
+        return -1;
+
+    struct fan_dev *f = new_dev(file);
+    if (!f)
+        return -1;
+
+    snprintf(enable, sizeof(enable), "%s_enable", file);
+    if (access(enable, F_OK) == 0)
+        snprintf(f->enable, sizeof(f->enable), "%s", enable);
+    f->max = PWM_MAX;
+    n_devs++;
+    return 0;
+}
+
+int fan_discover(void)
+{
+    DIR *d = opendir(CDEV_DIR);
+    if (!d) return 0;
+
+    int n = 0;
+    struct dirent *de;
+    while ((de = readdir(d))) {
+        int idx;
+        if (sscanf(de->d_name, "cooling_device%d", &idx) != 1)
+            continue;
+
+        char dir[128], path[160], type[64];
+        snprintf(dir, sizeof(dir), CDEV_DIR "/cooling_device%d", idx);
+        snprintf(path, sizeof(path), "%s/type", dir);
+
+        FILE *fp = fopen(path, "r");
+        if (!fp) continue;
+        if (!fgets(type, sizeof(type), fp))
+            type[0] = '\0';
+        fclose(fp);
+
+        if (strcasestr(type, "fan") && add_cdev(dir) == 0)
+            n++;
+    }
+
+    closedir(d);
+    return n;
+}
+
+int fan_add(const char *path)
+{
+    const char *base = strrchr(path, '/');
+    int rc;
+
+    base = base ? base + 1 : path;
+    if (strncmp(base, "pwm", 3) == 0)
+        rc = add_pwm(path);
+    else
+        rc = add_cdev(path);
+
+    if (rc < 0)
+        fprintf(stderr, "fan: %s is not a usable cooling device or "
+                "pwm output\n", path);
+    return rc;
+}
+
+int fan_count(void)
+{
+    return n_devs;
+}
+
+static void write_int(const char *path, int v)
+{
+    char val[16];
+    snprintf(val, sizeof(val), "%d", v);
+    journal_write(path, val);
+}
+
+void fan_set(double level)
+{
+    if (level <= 0.0) {
+        fan_restore();
+        return;
+    }
+    if (level > 1.0)
+        level = 1.0;
+
+    for (int i = 0; i < n_devs; i++) {
+        struct fan_dev *f = &devs[i];
+
+        if (f->applied < 0) {
+            if (read_int_file(f->path, &f->base) < 0 || f->base > f->max)
+                f->base = 0;
+        }
+
+        int v = f->base + (int)ceil((f->max - f->base) * level);
+        if (v == f->applied)
+            continue;
+
+        write_int(f->path, v);
+        if (f->applied < 0 && f->enable[0]) {
+            journal_write(f->enable, "1");
+            write_int(f->path, v);
+        }
+        f->applied = v;
+    }
+
+    atomic_store(&level_pm, (int)lround(level * 1000.0));
+}
+
+double fan_level(void)
+{
+    return atomic_load(&level_pm) / 1000.0;
+}
+
+void fan_restore(void)
+{
+    for (int i = 0; i < n_devs; i++) {
+        struct fan_dev *f = &devs[i];
+
+        if (f->applied < 0)
+            continue;
+        journal_restore(f->path);
+        if (f->enable[0])
+            journal_restore(f->enable);
+        f->applied = -1;
+    }
+
+    atomic_store(&level_pm, 0);
+}
@@ -0,0 +1,39 @@
+/*
+ * Fan actuator: thermal cooling devices and hwmon PWM outputs
+ *
+ * The first step of mitigation. Extra airflow costs no throughput, so
+ * the controller raises fans before it caps frequency and lowers them
+ * only once the cap is gone. Every device is driven to the same level,
+ * 0..1 of the way from where it was found to its maximum.
+ */
+
+#ifndef RC_FAN_H
+#define RC_FAN_H
+
+#define FAN_MAX_DEVICES 16
+
+/*
+ * Register every cooling device whose type names a fan ("Fan",
+ * "pwm-fan"). Returns how many were found.
+ */
+int fan_discover(void);
+
+/*
+ * Register a cooling device directory (.../cooling_deviceN) or a
+ * hwmon PWM file (.../hwmonN/pwmM). 0, or -1 if unusable.
+ */
+int fan_add(const char *path);
+
+/* Number of registered devices */
+int fan_count(void);
+
+/* Drive every device to `level` (0..1); 0 puts the originals back */
+void fan_set(double level);
+
+/* Level last applied; safe from any thread */
+double fan_level(void);
+
+/* Put back the values found before the first change */
+void fan_restore(void);
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Thermal headroom page: writer side (daemon)
+ *
+ * Published by the actuator thread only, like the telemetry page. The
+ * futex wake costs one syscall per decision whether or not a client is
+ * waiting: counting waiters would need clients to write to the page.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "headroom.h"
+#include "seqlock.h"
+
+static struct rc_headroom_page *page = NULL;
+static char page_path[256];
+
+int headroom_open(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(*page)) < 0) {
+        fprintf(stderr, "headroom: %s: %s\n", path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+
+    void *p = mmap(NULL, sizeof(*page), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    page = p;
+    memset(page, 0, sizeof(*page));
+    page->version = RC_HEADROOM_VERSION;
+    page->size = sizeof(*page);
+    page->writer_pid = (uint32_t)getpid();
+    /* magic last: readers reject the page until the header is complete */
+    atomic_thread_fence(memory_order_release);
+    page->magic = RC_HEADROOM_MAGIC;
+
+    snprintf(page_path, sizeof(page_path), "%s", path);
+    return 0;
+}
+
+void headroom_publish(const struct sample_rec *r, const struct rc_params *p,
+                      uint32_t mitigation_level)
+{
+    if (!page)
+        return;
+
+    struct rc_headroom_data d;
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+
+    memset(&d, 0, sizeof(d));
+    d.sample_seq = r->seq;
+    d.t_wall_ns = (int64_t)wall.tv_sec * 1000000000LL + wall.tv_nsec;
+    d.valid = (uint32_t)r->valid;
+    d.mitigation_level = mitigation_level;
+    d.temp_c = r->T_curr;
+    d.power_w = r->power;
+    d.t_high = p->t_high;
+    d.t_ambient = p->t_ambient;
+    d.r_thermal = p->r_thermal;
+    d.c_thermal = p->c_thermal;
+    d.watts = rc_headroom_watts(&d, INFINITY);
+    d.seconds = rc_headroom_seconds(&d, 0.0);
+
+    seq_write_begin(&page->seq);
+    memcpy(&page->data, &d, sizeof(d));
+    seq_write_end(&page->seq);
+
+    syscall(SYS_futex, &page->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+void headroom_close(void)
+{
+    if (!page)
+        return;
+
+    munmap(page, sizeof(*page));
+    page = NULL;
+    unlink(page_path);
+}
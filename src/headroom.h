@@ -0,0 +1,21 @@
+/*
+ * Thermal headroom page: writer side (daemon)
+ */
+
+#ifndef RC_HEADROOM_WRITER_H
+#define RC_HEADROOM_WRITER_H
+
+#include "rc_headroom.h"
+#include "sample.h"
+#include "config.h"
+
+/* Create/map the headroom file; returns 0 or -1 (headroom disabled) */
+int headroom_open(const char *path);
+
+/* Derive headroom from a decided sample and wake waiting clients */
+void headroom_publish(const struct sample_rec *r, const struct rc_params *p,
+                      uint32_t mitigation_level);
+
+void headroom_close(void);
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Sensor health: spike rejection, stuck and stale detection
+ *
+ * The Hampel window only holds accepted values, so a burst of spikes
+ * cannot drag the median towards itself. MAD is scaled by 1.4826 to
+ * estimate the standard deviation of normal noise.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "health.h"
+
+#define MAD_SCALE   1.4826
+#define LAT_ALPHA   0.05
+
+void health_reset(struct sensor_health *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->same_raw = -1.0;
+    h->st.last_good_t = -1.0;
+}
+
+static double median(const double *v, unsigned n)
+{
+    double s[HEALTH_WINDOW];
+
+    memcpy(s, v, n * sizeof(*s));
+    for (unsigned i = 1; i < n; i++) {
+        double x = s[i];
+        unsigned j = i;
+        for (; j > 0 && s[j - 1] > x; j--)
+            s[j] = s[j - 1];
+        s[j] = x;
+    }
+    return n % 2 ? s[n / 2] : (s[n / 2 - 1] + s[n / 2]) / 2.0;
+}
+
+static void latency(struct health_stats *st, double latency_s)
+{
+    double us = latency_s * 1e6;
+
+    st->lat_last_us = us;
+    if (us > st->lat_max_us)
+        st->lat_max_us = us;
+    st->lat_mean_us = st->reads == 1 ? us :
+                      st->lat_mean_us + LAT_ALPHA * (us - st->lat_mean_us);
+}
+
+/* 1 while the value has not moved through a change the model expects */
+static int stuck(struct sensor_health *h, const struct health_limits *lim,
+                 double now, double raw, double expect)
+{
+    if (raw != h->same_raw) {
+        h->same_raw = raw;
+        h->same_since = now;
+        h->exp_lo = h->exp_hi = expect;
+        h->st.stuck = 0;
+        return 0;
+    }
+
+    if (expect < h->exp_lo) h->exp_lo = expect;
+    if (expect > h->exp_hi) h->exp_hi = expect;
+
+    if (!h->st.stuck && now - h->same_since >= lim->stuck_s &&
+        h->exp_hi - h->exp_lo > lim->stuck_delta) {
+        h->st.stuck = 1;
+        h->st.stuck_events++;
+    }
+    return h->st.stuck;
+}
+
+/* 1 if raw is a spike to reject */
+static int spike(struct sensor_health *h, double raw)
+{
+    if (h->n < 3)
+        return 0;
+
+    double dev[HEALTH_WINDOW];
+    double med = median(h->win, h->n);
+
+    for (unsigned i = 0; i < h->n; i++)
+        dev[i] = fabs(h->win[i] - med);
+
+    double band = HEALTH_HAMPEL_K * MAD_SCALE * median(dev, h->n);
+    if (band < HEALTH_MIN_DEV)
+        band = HEALTH_MIN_DEV;
+
+    if (fabs(raw - med) <= band) {
+        h->outliers = 0;
+        return 0;
+    }
+
+    int side = raw > med ? 1 : -1;
+    h->outliers = side == h->outlier_side ? h->outliers + 1 : 1;
+    h->outlier_side = side;
+    if (h->outliers <= HEALTH_SPIKE_MAX) {
+        h->st.spikes++;
+        return 1;
+    }
+
+    /* a level shift: start the window over from here */
+    h->n = h->head = 0;
+    h->outliers = 0;
+    return 0;
+}
+
+double health_filter(struct sensor_health *h,
+                     const struct health_limits *lim, double now,
+                     double raw, double expect, double latency_s)
+{
+    h->st.reads++;
+    latency(&h->st, latency_s);
+
+    if (raw < 0.0 || !isfinite(raw) || raw > HEALTH_T_MAX) {
+        h->st.failures++;
+    }
+    else if (!stuck(h, lim, now, raw, expect) && !spike(h, raw)) {
+        h->win[h->head] = raw;
+        h->head = (h->head + 1) % HEALTH_WINDOW;
+        if (h->n < HEALTH_WINDOW)
+            h->n++;
+
+        h->last_good = raw;
+        h->st.last_good_t = now;
+        h->st.held = 0;
+        h->bad = 0;
+        return raw;
+    }
+
+    h->bad++;
+    h->st.held = h->st.last_good_t >= 0.0 && h->bad <= lim->stale_reads;
+    return h->st.held ? h->last_good : -1.0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Sensor health: spike rejection, stuck and stale detection
+ *
+ * Every temperature read passes through a health filter before the
+ * controller sees it:
+ *
+ *  - A Hampel filter over the last HEALTH_WINDOW accepted values
+ *    rejects a reading further than HEALTH_HAMPEL_K scaled MADs from
+ *    their median. More than HEALTH_SPIKE_MAX in a row in the same
+ *    direction are a real step, not a spike, and are accepted.
+ *  - A value that does not move for stuck_s while the temperature the
+ *    model expects swings by more than stuck_delta is a stuck sensor.
+ *    A quantized sensor on a saturated package sits still because the
+ *    model says it should, so it is not flagged.
+ *  - Rejected, failed and stuck reads hold the last good value for up
+ *    to stale_reads reads in a row, i.e. sampling periods, so the
+ *    limit scales with the period; after that the sensor is reported
+ *    invalid.
+ *
+ * Read latency is tracked alongside. Times are on the platform clock.
+ */
+
+#ifndef RC_HEALTH_H
+#define RC_HEALTH_H
+
+#include <stdint.h>
+
+#define HEALTH_WINDOW       7
+#define HEALTH_HAMPEL_K     3.0
+#define HEALTH_MIN_DEV      2.0     // °C, floor on the rejection band
+#define HEALTH_SPIKE_MAX    2       // consecutive outliers rejected
+#define HEALTH_T_MAX        150.0   // °C, anything above is a bad read
+
+/* Thresholds, from the parameter set (sensor_*) */
+struct health_limits {
+    unsigned stale_reads;       // held reads before invalid
+    double stuck_s;
+    double stuck_delta;         // °C, above the sensor's resolution
+};
+
+/* Counters and timestamps, for reporting */
+struct health_stats {
+    uint64_t reads;
+    uint64_t failures;          // read failed or implausible
+    uint64_t spikes;            // rejected by the Hampel filter
+    uint64_t stuck_events;
+    int stuck;                  // currently stuck
+    int held;                   // last result was a held value
+    double last_good_t;         // platform clock, <0 never
+    double lat_last_us;
+    double lat_max_us;
+    double lat_mean_us;         // EWMA
+};
+
+struct sensor_health {
+    double win[HEALTH_WINDOW];
+    unsigned n, head;
+    double last_good;
+    double same_raw;            // value the stuck check is following
+    double same_since;
+    double exp_lo, exp_hi;      // expected temperature meanwhile
+    unsigned bad;               // reads in a row not accepted
+    unsigned outliers;          // consecutive, same side
+    int outlier_side;
+    struct health_stats st;
+};
+
+void health_reset(struct sensor_health *h);
+
+/*
+ * Feed one read: `raw` °C (negative on failure), the temperature the
+ * model expects at the current load (its steady state), read latency
+ * in seconds. Returns the value to act on, or -1 when there is none
+ * fresh enough.
+ */
+double health_filter(struct sensor_health *h,
+                     const struct health_limits *lim, double now,
+                     double raw, double expect, double latency_s);
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Log-linear latency histogram (HDR-style)
+ *
+ * Each power of two is split into HIST_SUB linear sub-buckets, so the
+ * recorded value is within 1/HIST_SUB (~6%) of the truth from 16 ns to
+ * centuries, in a fixed 8 KB array. Single writer; readers use relaxed
+ * loads and may see a sample counted in `total` before its bucket.
+ */
+
+#ifndef RC_HISTOGRAM_H
+#define RC_HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define HIST_SUB_BITS   4
+#define HIST_SUB        (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS    ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+struct hist {
+    atomic_ullong bucket[HIST_BUCKETS];
+    atomic_ullong total;
+    atomic_ullong max;
+};
+
+static inline unsigned hist_index(uint64_t v)
+{
+    if (v < HIST_SUB)
+        return (unsigned)v;
+
+    unsigned shift = 63 - __builtin_clzll(v) - HIST_SUB_BITS;
+    unsigned sub = (unsigned)(v >> shift) & (HIST_SUB - 1);
+
+    return (shift + 1) * HIST_SUB + sub;
+}
+
+/* Smallest value that lands in bucket `idx` */
+static inline uint64_t hist_bucket_low(unsigned idx)
+{
+    if (idx < HIST_SUB)
+        return idx;
+
+    unsigned shift = idx / HIST_SUB - 1;
+    return (uint64_t)(HIST_SUB + idx % HIST_SUB) << shift;
+}
+
+static inline void hist_bump(atomic_ullong *c, unsigned long long by)
+{
+    atomic_store_explicit(c,
+        atomic_load_explicit(c, memory_order_relaxed) + by,
+        memory_order_relaxed);
+}
+
+static inline void hist_record(struct hist *h, uint64_t v)
+{
+    hist_bump(&h->bucket[hist_index(v)], 1);
+    hist_bump(&h->total, 1);
+    if (v > atomic_load_explicit(&h->max, memory_order_relaxed))
+        atomic_store_explicit(&h->max, v, memory_order_relaxed);
+}
+
+/* Lower bound of the bucket holding quantile q (0..1) */
+static inline uint64_t hist_quantile(struct hist *h, double q)
+{
+    unsigned long long total =
+        atomic_load_explicit(&h->total, memory_order_relaxed);
+    unsigned long long want = (unsigned long long)(q * total + 0.5);
+    unsigned long long seen = 0;
+
+    if (want == 0)
+        want = 1;
+
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->bucket[i], memory_order_relaxed);
+        if (seen >= want)
+            return hist_bucket_low(i);
+    }
+
+    return atomic_load_explicit(&h->max, memory_order_relaxed);
+}
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ * In-process multi-resolution history (RRD style)
+ *
+ * Each level accumulates min, max, sum and count per series for the
+ * bucket being filled. When a sample lands past that bucket, it is
+ * written to the level's ring, merged into the next level's bucket,
+ * and any buckets nothing arrived in are written as empty (NaN), so a
+ * bucket's time is always its distance from the newest. Wall-clock
+ * steps backwards land in the current bucket.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#include "history.h"
+#include "seqlock.h"
+
+#define NS_PER_S    1000000000LL
+
+enum {
+    S_FREQ,                         // GHz
+    S_POWER,                        // W
+    S_CAP,                          // MHz, NaN while uncapped
+    S_ZONE0,                        // °C
+    N_SERIES = S_ZONE0 + HISTORY_ZONES
+};
+
+struct bucket {
+    float min, max, mean;           // NaN: no samples
+};
+
+struct acc {
+    double min, max, sum;
+    unsigned n;
+};
+
+struct level {
+    const char *name;
+    int64_t res_ns;
+    unsigned size;
+    struct bucket *ring;            // size rows of N_SERIES
+    unsigned head, n;               // next row, rows filled
+    int64_t last_t;                 // start of the newest row
+    int64_t acc_t;                  // start of the bucket filling, 0 none
+    struct acc acc[N_SERIES];
+};
+
+static struct bucket ring_sec[HISTORY_SECONDS][N_SERIES];
+static struct bucket ring_min[HISTORY_MINUTES][N_SERIES];
+static struct bucket ring_hour[HISTORY_HOURS][N_SERIES];
+
+static struct level levels[] = {
+    { .name = "1s", .res_ns = NS_PER_S, .size = HISTORY_SECONDS,
+      .ring = &ring_sec[0][0] },
+    { .name = "1m", .res_ns = 60 * NS_PER_S, .size = HISTORY_MINUTES,
+      .ring = &ring_min[0][0] },
+    { .name = "1h", .res_ns = 3600 * NS_PER_S, .size = HISTORY_HOURS,
+      .ring = &ring_hour[0][0] },
+};
+#define N_LEVELS    (int)(sizeof(levels) / sizeof(levels[0]))
+
+/* level_report() copies a column of the longest ring onto the stack */
+#define LONGEST_RING    HISTORY_MINUTES
+_Static_assert(HISTORY_SECONDS <= LONGEST_RING &&
+               HISTORY_HOURS <= LONGEST_RING, "longest ring");
+
+static float raw[HISTORY_RAW][N_SERIES];
+static int64_t raw_t[HISTORY_RAW];
+static unsigned raw_head, raw_n;
+static unsigned n_zones;
+
+static atomic_uint seq;
+
+static const char *series_name(int s, char *buf, size_t len)
+{
+    static const char *const fixed[] = { "freq", "power", "cap" };
+
+    if (s < S_ZONE0)
+        return fixed[s];
+    snprintf(buf, len, "zone%d", s - S_ZONE0);
+    return buf;
+}
+
+/* =======================
+   Writer (actuator thread)
+   ======================= */
+static void push(struct level *lv, int64_t t, const struct acc *a)
+{
+    struct bucket *row = lv->ring + (size_t)lv->head * N_SERIES;
+
+    for (int s = 0; s < N_SERIES; s++) {
+        if (a && a[s].n) {
+            row[s].min = (float)a[s].min;
+            row[s].max = (float)a[s].max;
+            row[s].mean = (float)(a[s].sum / a[s].n);
+        }
+        else {
+            row[s].min = row[s].max = row[s].mean = NAN;
+        }
+    }
+
+    lv->head = (lv->head + 1) % lv->size;
+    if (lv->n < lv->size)
+        lv->n++;
+    lv->last_t = t;
+}
+
+static void merge(struct acc *dst, const struct acc *src)
+{
+    for (int s = 0; s < N_SERIES; s++) {
+        if (!src[s].n)
+            continue;
+        if (!dst[s].n || src[s].min < dst[s].min) dst[s].min = src[s].min;
+        if (!dst[s].n || src[s].max > dst[s].max) dst[s].max = src[s].max;
+        dst[s].sum += src[s].sum;
+        dst[s].n += src[s].n;
+    }
+}
+
+static void level_add(int l, int64_t t, const struct acc *a)
+{
+    struct level *lv = &levels[l];
+    int64_t start = t - t % lv->res_ns;
+
+    if (!lv->acc_t) {
+        lv->acc_t = start;
+    }
+    else if (start > lv->acc_t) {
+        push(lv, lv->acc_t, lv->acc);
+        if (l + 1 < N_LEVELS)
+            level_add(l + 1, lv->acc_t, lv->acc);
+
+        int64_t gap = (start - lv->acc_t) / lv->res_ns - 1;
+        if (gap > lv->size)
+            gap = lv->size;
+        for (int64_t i = gap; i > 0; i--)
+            push(lv, start - i * lv->res_ns, NULL);
+
+        memset(lv->acc, 0, sizeof(lv->acc));
+        lv->acc_t = start;
+    }
+
+    merge(lv->acc, a);
+}
+
+void history_append(const struct rc_telem_data *d)
+{
+    double v[N_SERIES];
+    struct acc a[N_SERIES];
+
+    for (int s = 0; s < N_SERIES; s++)
+        v[s] = NAN;
+    if (d->valid) {
+        v[S_FREQ] = d->freq_ghz;
+        v[S_POWER] = d->power_w;
+        for (unsigned k = 0; k < d->n_zones && k < HISTORY_ZONES; k++)
+            v[S_ZONE0 + k] = d->zones[k].temp_c;
+    }
+    if (d->cap_khz > 0)
+        v[S_CAP] = d->cap_khz / 1000.0;
+
+    for (int s = 0; s < N_SERIES; s++) {
+        a[s].min = a[s].max = a[s].sum = v[s];
+        a[s].n = !isnan(v[s]);
+    }
+
+    seq_write_begin(&seq);
+
+    for (int s = 0; s < N_SERIES; s++)
+        raw[raw_head][s] = (float)v[s];
+    raw_t[raw_head] = d->t_wall_ns;
+    raw_head = (raw_head + 1) % HISTORY_RAW;
+    if (raw_n < HISTORY_RAW)
+        raw_n++;
+    if (d->n_zones > n_zones)
+        n_zones = d->n_zones < HISTORY_ZONES ? d->n_zones : HISTORY_ZONES;
+
+    level_add(0, d->t_wall_ns, a);
+
+    seq_write_end(&seq);
+}
+
+/* =======================
+   Control command
+   ======================= */
+static void fmt_time(int64_t ns, int ms, char *buf, size_t len)
+{
+    time_t sec = (time_t)(ns / NS_PER_S);
+    struct tm tm;
+    size_t n;
+
+    localtime_r(&sec, &tm);
+    n = strftime(buf, len, "%Y-%m-%d %H:%M:%S", &tm);
+    if (ms && n < len)
+        snprintf(buf + n, len - n, ".%03d",
+                 (int)(ns % NS_PER_S / 1000000));
+}
+
+static void summary(struct ctl_reply *r)
+{
+    unsigned n[N_LEVELS + 1], zones;
+    int64_t newest[N_LEVELS + 1];
+    unsigned s0;
+    char name[16], when[32];
+
+    do {
+        s0 = seq_read_begin(&seq);
+        n[0] = raw_n;
+        newest[0] = raw_n ? raw_t[(raw_head + HISTORY_RAW - 1) %
+                                  HISTORY_RAW] : 0;
+        for (int l = 0; l < N_LEVELS; l++) {
+            n[l + 1] = levels[l].n;
+            newest[l + 1] = levels[l].last_t;
+        }
+        zones = n_zones;
+    } while (seq_read_retry(&seq, s0));
+
+    ctl_printf(r, "series:");
+    for (int s = 0; s < S_ZONE0 + (int)zones; s++)
+        ctl_printf(r, " %s", series_name(s, name, sizeof(name)));
+    ctl_printf(r, "\n%-4s %6s %6s  %s\n", "res", "kept", "max", "newest");
+
+    for (int l = 0; l <= N_LEVELS; l++) {
+        fmt_time(newest[l], l == 0, when, sizeof(when));
+        ctl_printf(r, "%-4s %6u %6u  %s\n",
+                   l ? levels[l - 1].name : "raw", n[l],
+                   l ? levels[l - 1].size : HISTORY_RAW,
+                   n[l] ? when : "-");
+    }
+}
+
+static void raw_report(int s, unsigned want, struct ctl_reply *r)
+{
+    float v[HISTORY_RAW];
+    int64_t t[HISTORY_RAW];
+    unsigned s0, n;
+    char when[32];
+
+    do {
+        s0 = seq_read_begin(&seq);
+        n = want < raw_n ? want : raw_n;
+        for (unsigned i = 0; i < n; i++) {
+            unsigned idx = (raw_head + HISTORY_RAW - n + i) % HISTORY_RAW;
+            v[i] = raw[idx][s];
+            t[i] = raw_t[idx];
+        }
+    } while (seq_read_retry(&seq, s0));
+
+    for (unsigned i = 0; i < n; i++) {
+        fmt_time(t[i], 1, when, sizeof(when));
+        if (isnan(v[i]))
+            ctl_printf(r, "%s -\n", when);
+        else
+            ctl_printf(r, "%s %.2f\n", when, v[i]);
+    }
+}
+
+static void level_report(const struct level *lv, int s, unsigned want,
+                         struct ctl_reply *r)
+{
+    struct bucket b[LONGEST_RING];
+    int64_t last_t;
+    unsigned s0, n;
+    char when[32];
+
+    do {
+        s0 = seq_read_begin(&seq);
+        n = want < lv->n ? want : lv->n;
+        for (unsigned i = 0; i < n; i++) {
+            unsigned row = (lv->head + lv->size - n + i) % lv->size;
+            b[i] = lv->ring[(size_t)row * N_SERIES + s];
+        }
+        last_t = lv->last_t;
+    } while (seq_read_retry(&seq, s0));
+
+    ctl_printf(r, "%-19s %8s %8s %8s\n", "time", "min", "max", "mean");
+    for (unsigned i = 0; i < n; i++) {
+        fmt_time(last_t - (int64_t)(n - 1 - i) * lv->res_ns, 0,
+                 when, sizeof(when));
+        if (isnan(b[i].mean))
+            ctl_printf(r, "%-19s %8s %8s %8s\n", when, "-", "-", "-");
+        else
+            ctl_printf(r, "%-19s %8.2f %8.2f %8.2f\n", when,
+                       b[i].min, b[i].max, b[i].mean);
+    }
+}
+
+void history_report(const char *args, struct ctl_reply *r)
+{
+    char want_s[16] = "", res[8] = "1m", name[16];
+    unsigned want = 60;
+    int s;
+
+    if (sscanf(args, "%15s %7s %u", want_s, res, &want) < 1) {
+        summary(r);
+        return;
+    }
+
+    for (s = 0; s < N_SERIES; s++)
+        if (strcmp(want_s, series_name(s, name, sizeof(name))) == 0)
+            break;
+    if (s == N_SERIES) {
+        ctl_printf(r, "unknown series '%s'\n", want_s);
+        return;
+    }
+
+    if (strcmp(res, "raw") == 0) {
+        raw_report(s, want, r);
+        return;
+    }
+    for (int l = 0; l < N_LEVELS; l++) {
+        if (strcmp(res, levels[l].name) == 0) {
+            level_report(&levels[l], s, want, r);
+            return;
+        }
+    }
+    ctl_printf(r, "unknown resolution '%s' (raw, 1s, 1m, 1h)\n", res);
+}
@@ -0,0 +1,36 @@
+/*
+ * In-process multi-resolution history (RRD style)
+ *
+ * Every decision is appended to a raw ring and folded into 1 s
+ * buckets; each bucket that closes is folded into the 1 min level and
+ * so on up to 1 h. Buckets keep min, max and mean per series, and all
+ * rings are fixed-size static arrays, so memory does not grow with
+ * uptime. Bucket boundaries follow the wall clock.
+ *
+ * The actuator thread appends; the control command reads under a
+ * seqlock, so queries never hold up the control loop.
+ */
+
+#ifndef RC_HISTORY_H
+#define RC_HISTORY_H
+
+#include "control.h"
+#include "rc_telemetry.h"
+
+#define HISTORY_ZONES       8
+#define HISTORY_RAW         600     // last decisions, at the sampling period
+#define HISTORY_SECONDS     900     // 15 min of 1 s buckets
+#define HISTORY_MINUTES     1440    // 24 h of 1 min buckets
+#define HISTORY_HOURS       720     // 30 days of 1 h buckets
+
+/* Append one decision; called from the actuator thread only */
+void history_append(const struct rc_telem_data *d);
+
+/*
+ * Control command. No arguments: what is kept. "SERIES [RES [N]]":
+ * the last N (default 60) entries of freq, power, cap or zone<K> at
+ * raw, 1s, 1m or 1h (default 1m), oldest first.
+ */
+void history_report(const char *args, struct ctl_reply *r);
+
+#endif
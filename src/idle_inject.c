@@ -0,0 +1,327 @@
+/*
+ * Forced idle injection actuator
+ *
+ * Backends, in order of preference:
+ *  - cpuidle cooling devices ("idle-cpuN"): per-CPU idle ratio driven
+ *    by the kernel's idle_inject framework, cur_state is a percentage
+ *  - intel_powerclamp: system-wide idle ratio, cur_state in percent
+ *  - virtual: only remembers the percentage (replay, simulation)
+ *
+ * Both kernel backends put the CPU in a real C-state. Without either,
+ * there is no injection: keeping the workload off a CPU by spinning
+ * on it in user space saves next to nothing, and the model would be
+ * told power went down when it did not.
+ *
+ * Each package asks for its own injection on its own CPUs. Powerclamp
+ * cannot tell packages apart, so it runs at the largest request.
+ *
+ * "Hottest" CPUs are ranked by busy time from /proc/stat, since there
+ * is no per-CPU temperature in the thermal zone we follow.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sched.h>
+#include <stdint.h>
+
+#include "idle_inject.h"
+#include "journal.h"
+
+#define IDLE_MAX_CPUS   256
+#define CDEV_DIR        "/sys/class/thermal"
+
+enum idle_backend {
+    BACKEND_NONE,
+    BACKEND_CPUIDLE_COOLING,
+    BACKEND_POWERCLAMP,
+    BACKEND_VIRTUAL,
+};
+
+struct cpu_slot {
+    int cpu;
+    unsigned long long busy, total;     // last /proc/stat sample
+    double load;                        // busy share of last interval
+    int cdev;                           // idle-cpuN cooling device or -1
+    int injecting;                      // percentage written, 0 none
+};
+
+static struct cpu_slot cpus[IDLE_MAX_CPUS];
+static int n_cpus = 0;
+static enum idle_backend backend = BACKEND_NONE;
+static int powerclamp_cdev = -1;
+static int powerclamp_max = 0;
+static int powerclamp_pct = 0;
+static int current_pct[IDLE_INJECT_MAX_PKG];
+static int8_t cpu_pkg[IDLE_MAX_CPUS];   // by cpu id; 0 until told
+
+static int read_int_file(const char *path, int *val)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    int ok = fscanf(fp, "%d", val) == 1;
+    fclose(fp);
+
+    return ok ? 0 : -1;
+}
+
+static void write_cdev_state(int cdev, int state)
+{
+    char path[128], val[16];
+    snprintf(path, sizeof(path), CDEV_DIR "/cooling_device%d/cur_state",
+             cdev);
+
+    if (state == 0) {
+        journal_restore(path);
+        return;
+    }
+
+    snprintf(val, sizeof(val), "%d", state);
+    journal_write(path, val);
+}
+
+static struct cpu_slot *slot_for_cpu(int cpu)
+{
+    for (int i = 0; i < n_cpus; i++)
+        if (cpus[i].cpu == cpu)
+            return &cpus[i];
+    return NULL;
+}
+
+/* Update per-CPU busy share from /proc/stat */
+static void sample_load(void)
+{
+    FILE *fp = fopen("/proc/stat", "r");
+    if (!fp) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        int cpu;
+        unsigned long long v[8] = { 0 };
+
+        if (sscanf(line, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu",
+                   &cpu, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
+                   &v[6], &v[7]) < 5)
+            continue;
+
+        struct cpu_slot *s = slot_for_cpu(cpu);
+        if (!s) continue;
+
+        unsigned long long idle = v[3] + v[4];
+        unsigned long long total = 0;
+        for (int i = 0; i < 8; i++)
+            total += v[i];
+        unsigned long long busy = total - idle;
+
+        if (s->total && total > s->total)
+            s->load = (double)(busy - s->busy) / (total - s->total);
+        s->busy = busy;
+        s->total = total;
+    }
+
+    fclose(fp);
+}
+
+static void probe_cooling_devices(void)
+{
+    DIR *d = opendir(CDEV_DIR);
+    if (!d) return;
+
+    struct dirent *de;
+    while ((de = readdir(d))) {
+        int idx;
+        if (sscanf(de->d_name, "cooling_device%d", &idx) != 1)
+            continue;
+
+        char path[128], type[64];
+        snprintf(path, sizeof(path), CDEV_DIR "/cooling_device%d/type", idx);
+
+        FILE *fp = fopen(path, "r");
+        if (!fp) continue;
+        if (!fgets(type, sizeof(type), fp))
+            type[0] = '\0';
+        fclose(fp);
+        type[strcspn(type, "\n")] = '\0';
+
+        int cpu;
+        if (sscanf(type, "idle-cpu%d", &cpu) == 1) {
+            struct cpu_slot *s = slot_for_cpu(cpu);
+            if (s) s->cdev = idx;
+        } else if (strcmp(type, "intel_powerclamp") == 0) {
+            snprintf(path, sizeof(path),
+                     CDEV_DIR "/cooling_device%d/max_state", idx);
+            if (read_int_file(path, &powerclamp_max) == 0)
+                powerclamp_cdev = idx;
+        }
+    }
+
+    closedir(d);
+}
+
+int idle_inject_init(void)
+{
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) < 0)
+        return 0;
+
+    n_cpus = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE && n_cpus < IDLE_MAX_CPUS; cpu++) {
+        if (!CPU_ISSET(cpu, &set))
+            continue;
+        cpus[n_cpus].cpu = cpu;
+        cpus[n_cpus].cdev = -1;
+        n_cpus++;
+    }
+
+    probe_cooling_devices();
+
+    int per_cpu_cdevs = 0;
+    for (int i = 0; i < n_cpus; i++)
+        per_cpu_cdevs += cpus[i].cdev >= 0;
+
+    if (per_cpu_cdevs > 0) {
+        backend = BACKEND_CPUIDLE_COOLING;
+    }
+    else if (powerclamp_cdev >= 0) {
+        backend = BACKEND_POWERCLAMP;
+        per_cpu_cdevs = n_cpus;
+    }
+    else {
+        backend = BACKEND_NONE;
+        return 0;
+    }
+
+    sample_load();
+    return per_cpu_cdevs;
+}
+
+void idle_inject_set_package(int cpu, int pkg)
+{
+    if (cpu >= 0 && cpu < IDLE_MAX_CPUS && pkg >= 0 &&
+        pkg < IDLE_INJECT_MAX_PKG)
+        cpu_pkg[cpu] = (int8_t)pkg;
+}
+
+void idle_inject_init_virtual(void)
+{
+    n_cpus = 0;
+    backend = BACKEND_VIRTUAL;
+}
+
+/* =======================
+   Injection control
+   ======================= */
+static void slot_set(struct cpu_slot *s, int pct)
+{
+    if (s->injecting == pct)
+        return;
+    write_cdev_state(s->cdev, pct);
+    s->injecting = pct;
+}
+
+static int pkg_of_cpu(int cpu)
+{
+    return cpu >= 0 && cpu < IDLE_MAX_CPUS ? cpu_pkg[cpu] : 0;
+}
+
+static void powerclamp_update(void)
+{
+    int pct = 0;
+
+    for (int k = 0; k < IDLE_INJECT_MAX_PKG; k++)
+        if (current_pct[k] > pct)
+            pct = current_pct[k];
+    if (pct != powerclamp_pct)
+        write_cdev_state(powerclamp_cdev, pct);
+    powerclamp_pct = pct;
+}
+
+static void pkg_stop(int pkg)
+{
+    if (backend == BACKEND_CPUIDLE_COOLING)
+        for (int i = 0; i < n_cpus; i++)
+            if (pkg_of_cpu(cpus[i].cpu) == pkg)
+                slot_set(&cpus[i], 0);
+
+    current_pct[pkg] = 0;
+    if (backend == BACKEND_POWERCLAMP)
+        powerclamp_update();
+}
+
+static int cmp_load_desc(const void *a, const void *b)
+{
+    const struct cpu_slot *x = *(struct cpu_slot * const *)a;
+    const struct cpu_slot *y = *(struct cpu_slot * const *)b;
+    return (x->load < y->load) - (x->load > y->load);
+}
+
+void idle_inject_set(int pkg, double fraction)
+{
+    if (backend == BACKEND_NONE || pkg < 0 || pkg >= IDLE_INJECT_MAX_PKG)
+        return;
+
+    if (fraction <= 0.0) {
+        pkg_stop(pkg);
+        return;
+    }
+
+    if (backend == BACKEND_VIRTUAL || backend == BACKEND_POWERCLAMP) {
+        int pct = (int)(fraction * 100.0 + 0.5);
+        int max = backend == BACKEND_VIRTUAL ||
+                  powerclamp_max > IDLE_INJECT_MAX_PCT ?
+                      IDLE_INJECT_MAX_PCT : powerclamp_max;
+        current_pct[pkg] = pct > max ? max : pct;
+        if (backend == BACKEND_POWERCLAMP)
+            powerclamp_update();
+        return;
+    }
+
+    sample_load();
+
+    struct cpu_slot *order[IDLE_MAX_CPUS];
+    int n = 0;
+    double total_load = 0.0;
+    for (int i = 0; i < n_cpus; i++) {
+        if (cpus[i].cdev < 0 || pkg_of_cpu(cpus[i].cpu) != pkg)
+            continue;
+        order[n++] = &cpus[i];
+        total_load += cpus[i].load;
+    }
+    if (n == 0)
+        return;
+    qsort(order, n, sizeof(order[0]), cmp_load_desc);
+
+    /* Inject on the package's busiest half, scaled up by their share */
+    int n_sel = n > 1 ? n / 2 : 1;
+    double sel_load = 0.0;
+    for (int i = 0; i < n_sel; i++)
+        sel_load += order[i]->load;
+
+    double share = total_load > 0.0 ? sel_load / total_load
+                                    : (double)n_sel / n;
+    int pct = (int)(fraction / share * 100.0 + 0.5);
+    if (pct > IDLE_INJECT_MAX_PCT) pct = IDLE_INJECT_MAX_PCT;
+    if (pct < 1) pct = 1;
+
+    for (int i = n_sel; i < n; i++)
+        slot_set(order[i], 0);
+    for (int i = 0; i < n_sel; i++)
+        slot_set(order[i], pct);
+
+    current_pct[pkg] = pct;
+}
+
+int idle_inject_pct(int pkg)
+{
+    return pkg >= 0 && pkg < IDLE_INJECT_MAX_PKG ? current_pct[pkg] : 0;
+}
+
+void idle_inject_stop(void)
+{
+    for (int k = 0; k < IDLE_INJECT_MAX_PKG; k++)
+        if (current_pct[k] > 0)
+            pkg_stop(k);
+}
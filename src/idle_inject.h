@@ -0,0 +1,43 @@
+/*
+ * Forced idle injection actuator
+ *
+ * Last line of defence once the frequency cap is in place and the
+ * prediction is still in the critical band. Uses the kernel's idle
+ * injection cooling devices (idle-cpuN, else intel_powerclamp); there
+ * is no injection without them.
+ */
+
+#ifndef RC_IDLE_INJECT_H
+#define RC_IDLE_INJECT_H
+
+#define IDLE_INJECT_MAX_PCT     50      // never take more than this per CPU
+#define IDLE_INJECT_MAX_PKG     8
+
+/*
+ * Probe backends and CPUs; returns the number of CPUs idle can be
+ * injected on, 0 when there is no kernel backend
+ */
+int idle_inject_init(void);
+
+/* Place cpu<cpu> in package `pkg`; every CPU is in package 0 until then */
+void idle_inject_set_package(int cpu, int pkg);
+
+/*
+ * Track the requested percentage without touching the system, for
+ * replay and simulation.
+ */
+void idle_inject_init_virtual(void);
+
+/*
+ * Remove `fraction` (0..1) of package `pkg`'s power by idling its
+ * hottest CPUs. 0 stops injection on the package.
+ */
+void idle_inject_set(int pkg, double fraction);
+
+/* Package `pkg`'s per-CPU injection percentage (0 when inactive) */
+int idle_inject_pct(int pkg);
+
+/* Stop injection everywhere and release the cooling devices */
+void idle_inject_stop(void);
+
+#endif
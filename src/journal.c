@@ -0,0 +1,298 @@
+/*
+ * Crash-safe journal of every limit the daemon changes
+ *
+ * The journal is a fixed array of slots in a MAP_SHARED file, so the
+ * page cache holds the latest state even if the process is killed.
+ * A slot becomes visible to restoration only once its path and
+ * original value are complete (state is written last), which lets
+ * journal_restore_all() run from a signal handler at any point.
+ *
+ * Controllers on different threads share the one journal; slot
+ * allocation is serialised with a mutex. journal_restore_all() does
+ * not take it, so it stays async-signal-safe.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "journal.h"
+
+#define JOURNAL_MAGIC   0x4a435352u     // "RSCJ"
+#define JOURNAL_VERSION 2
+
+#define SLOT_FREE       0
+#define SLOT_VALID      1
+
+struct journal_slot {
+    char path[JOURNAL_PATH_MAX];
+    char original[JOURNAL_VALUE_MAX];
+    char applied[JOURNAL_VALUE_MAX];
+    uint32_t state;
+    uint32_t pad;
+};
+
+/* Version 1 slots, before they grew to hold a full cpu list */
+struct journal_slot_v1 {
+    char path[208];
+    char original[20];
+    char applied[20];
+    uint32_t state;
+    uint32_t pad;
+};
+
+struct journal_file {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pid;
+    uint32_t pad;
+    struct journal_slot slots[JOURNAL_SLOTS];
+};
+
+static struct journal_file *jf = NULL;
+static int file_backed = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Plain open/read/write keeps the restore path async-signal-safe */
+static int sysfs_write(const char *path, const char *value)
+{
+    int fd = open(path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    /* an empty original (cpuset.cpus) needs a real write to come back */
+    if (!*value)
+        value = "\n";
+
+    ssize_t len = (ssize_t)strlen(value);
+    ssize_t n = write(fd, value, len);
+    close(fd);
+
+    return n == len ? 0 : -1;
+}
+
+/* -1 as well when the value does not fit: it would restore truncated */
+static int sysfs_read(const char *path, char *buf, size_t len)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ssize_t n = read(fd, buf, len);
+    close(fd);
+    if (n <= 0 || (size_t)n >= len) return -1;
+
+    buf[n] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static void journal_sync(void)
+{
+    if (file_backed)
+        msync(jf, sizeof(*jf), MS_SYNC);
+}
+
+/* Only the pages `s` spans: a whole-file sync per cap step is ~400 KB */
+static void journal_sync_slot(const struct journal_slot *s)
+{
+    if (!file_backed)
+        return;
+
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)s & ~(page - 1);
+    uintptr_t end = (uintptr_t)(s + 1);
+
+    msync((void *)start, end - start, MS_SYNC);
+}
+
+/*
+ * A journal left by a version 1 daemon that died with limits applied:
+ * put its originals back before the file is reset. An original that
+ * filled its 19 bytes may have been cut off (a long cpuset.cpus), so
+ * it is reported rather than written.
+ */
+static void restore_v1(void)
+{
+    const struct journal_slot_v1 *v1 = (const void *)jf->slots;
+    _Static_assert(JOURNAL_SLOTS * sizeof(*v1) <= sizeof(jf->slots),
+                   "v1 slots fit the current mapping");
+
+    for (int i = 0; i < JOURNAL_SLOTS; i++) {
+        const struct journal_slot_v1 *s = &v1[i];
+        char path[sizeof(s->path)], original[sizeof(s->original)];
+
+        if (s->state != SLOT_VALID ||
+            !memchr(s->path, '\0', sizeof(s->path)) ||
+            !memchr(s->original, '\0', sizeof(s->original)))
+            continue;
+        memcpy(path, s->path, sizeof(path));
+        memcpy(original, s->original, sizeof(original));
+
+        if (strlen(original) == sizeof(original) - 1)
+            fprintf(stderr, "journal: %s: saved value '%s' may be "
+                    "truncated, not restored\n", path, original);
+        else if (sysfs_write(path, original) < 0)
+            fprintf(stderr, "journal: %s: cannot restore '%s'\n",
+                    path, original);
+        else
+            fprintf(stderr, "journal: restored %s from a version 1 "
+                    "journal\n", path);
+    }
+}
+
+static void make_parent_dir(const char *path)
+{
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s", path);
+
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+    }
+}
+
+int journal_open(const char *path)
+{
+    make_parent_dir(path);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd >= 0 && ftruncate(fd, sizeof(*jf)) == 0) {
+        jf = mmap(NULL, sizeof(*jf), PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+        file_backed = jf != MAP_FAILED;
+    }
+    if (fd >= 0)
+        close(fd);
+
+    if (!file_backed) {
+        fprintf(stderr, "journal: cannot map %s (%s), limits will not "
+                "survive a crash\n", path, strerror(errno));
+        jf = mmap(NULL, sizeof(*jf), PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (jf == MAP_FAILED) {
+            jf = NULL;
+            return 0;
+        }
+    }
+
+    /* Unknown layout: start over rather than restore garbage */
+    if (jf->magic == JOURNAL_MAGIC && jf->version == 1)
+        restore_v1();
+    if (jf->magic != JOURNAL_MAGIC || jf->version != JOURNAL_VERSION) {
+        memset(jf, 0, sizeof(*jf));
+        jf->magic = JOURNAL_MAGIC;
+        jf->version = JOURNAL_VERSION;
+    }
+
+    int stale = 0;
+    for (int i = 0; i < JOURNAL_SLOTS; i++)
+        stale += jf->slots[i].state == SLOT_VALID;
+
+    jf->pid = (uint32_t)getpid();
+    journal_sync();
+
+    return stale;
+}
+
+static struct journal_slot *find_slot(const char *path)
+{
+    for (int i = 0; i < JOURNAL_SLOTS; i++)
+        if (jf->slots[i].state == SLOT_VALID &&
+            strcmp(jf->slots[i].path, path) == 0)
+            return &jf->slots[i];
+    return NULL;
+}
+
+int journal_write(const char *path, const char *value)
+{
+    if (!jf)
+        return sysfs_write(path, value);
+
+    if (strlen(value) >= JOURNAL_VALUE_MAX) {
+        fprintf(stderr, "journal: value for %s too long, not writing\n",
+                path);
+        return -1;
+    }
+
+    pthread_mutex_lock(&lock);
+    struct journal_slot *s = find_slot(path);
+
+    if (!s) {
+        for (int i = 0; i < JOURNAL_SLOTS && !s; i++)
+            if (jf->slots[i].state == SLOT_FREE)
+                s = &jf->slots[i];
+
+        if (!s || strlen(path) >= sizeof(s->path)) {
+            pthread_mutex_unlock(&lock);
+            fprintf(stderr, "journal: cannot record %s, not writing\n",
+                    path);
+            return -1;
+        }
+
+        char original[sizeof(s->original)];
+        if (sysfs_read(path, original, sizeof(original)) < 0) {
+            pthread_mutex_unlock(&lock);
+            fprintf(stderr, "journal: cannot read the original of %s, "
+                    "not writing\n", path);
+            return -1;
+        }
+
+        memcpy(s->path, path, strlen(path) + 1);
+        memcpy(s->original, original, sizeof(original));
+        atomic_signal_fence(memory_order_release);
+        s->state = SLOT_VALID;
+    }
+
+    snprintf(s->applied, sizeof(s->applied), "%s", value);
+    journal_sync_slot(s);
+    pthread_mutex_unlock(&lock);
+
+    return sysfs_write(path, value);
+}
+
+int journal_restore(const char *path)
+{
+    if (!jf)
+        return -1;
+
+    pthread_mutex_lock(&lock);
+    struct journal_slot *s = find_slot(path);
+    if (!s) {
+        pthread_mutex_unlock(&lock);
+        return -1;
+    }
+
+    int rc = sysfs_write(s->path, s->original);
+    s->state = SLOT_FREE;
+    journal_sync_slot(s);
+    pthread_mutex_unlock(&lock);
+
+    return rc;
+}
+
+int journal_restore_all(void)
+{
+    if (!jf)
+        return 0;
+
+    int n = 0;
+    for (int i = 0; i < JOURNAL_SLOTS; i++) {
+        struct journal_slot *s = &jf->slots[i];
+        if (s->state != SLOT_VALID)
+            continue;
+
+        atomic_signal_fence(memory_order_acquire);
+        if (sysfs_write(s->path, s->original) == 0)
+            n++;
+        s->state = SLOT_FREE;
+    }
+
+    return n;
+}
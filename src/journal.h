@@ -0,0 +1,39 @@
+/*
+ * Crash-safe journal of every limit the daemon changes
+ *
+ * Each sysfs/cgroup write goes through journal_write(), which records
+ * the value found before the first change (and the value applied) in
+ * a memory-mapped file before touching the target. If rc_sched dies
+ * with limits applied, the next start replays the journal and puts
+ * the originals back.
+ */
+
+#ifndef RC_JOURNAL_H
+#define RC_JOURNAL_H
+
+#define JOURNAL_PATH    "/run/rc_sched/journal"
+#define JOURNAL_SLOTS   512     // one per capped policy, plus cgroups
+#define JOURNAL_PATH_MAX    256
+#define JOURNAL_VALUE_MAX   256     // room for a full cpuset.cpus list
+
+/*
+ * Map the journal file; falls back to anonymous memory (restoration
+ * on signals still works, crash recovery does not).
+ * Returns the number of entries left behind by a previous run.
+ */
+int journal_open(const char *path);
+
+/*
+ * Record `path` in the journal, then write `value` to it. Refuses (-1,
+ * nothing written) when the path, the original or the value does not
+ * fit a slot, since a truncated original cannot be restored.
+ */
+int journal_write(const char *path, const char *value);
+
+/* Write back the original of `path` and drop its entry */
+int journal_restore(const char *path);
+
+/* Restore every entry. Async-signal-safe. Returns entries restored. */
+int journal_restore_all(void);
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * First-order RC thermal model
+ */
+
+#include <math.h>
+
+#include "model.h"
+
+/* =======================
+   RC Thermal Model
+   ======================= */
+double predict_temperature(
+    double T_curr,
+    double power,
+    double Tamb,
+    double R,
+    double C,
+    double dt
+) {
+    return T_curr + (dt / C) * (power - (T_curr - Tamb) / R);
+}
+
+/* Closed form of the same model: T after `t` seconds at constant power */
+double project_temperature(
+    double T_curr,
+    double power,
+    double Tamb,
+    double R,
+    double C,
+    double t
+) {
+    double T_ss = Tamb + power * R;
+    return T_ss + (T_curr - T_ss) * exp(-t / (R * C));
+}
+
+/* More airflow carries heat away faster: a smaller R, same C */
+double effective_resistance(double R, double r_factor, double cooling)
+{
+    if (cooling <= 0.0)
+        return R;
+    if (cooling > 1.0)
+        cooling = 1.0;
+    return R * (1.0 - (1.0 - r_factor) * cooling);
+}
+
+/*
+ * Share of `power` that has to go for the next step to land on
+ * T_target, i.e. predict_temperature() solved for the power term.
+ */
+double idle_fraction_for_target(
+    double T_curr,
+    double power,
+    double T_target,
+    double Tamb,
+    double R,
+    double C,
+    double dt
+) {
+    if (power <= 0.0)
+        return 0.0;
+
+    double allowed = C * (T_target - T_curr) / dt + (T_curr - Tamb) / R;
+    double frac = 1.0 - allowed / power;
+
+    return frac < 0.0 ? 0.0 : (frac > 1.0 ? 1.0 : frac);
+}
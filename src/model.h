@@ -0,0 +1,30 @@
+/*
+ * First-order RC thermal model
+ *
+ * dT/dt = (P - (T - T_amb) / R) / C. Pure functions of their
+ * arguments, safe to call from any thread.
+ */
+
+#ifndef RC_MODEL_H
+#define RC_MODEL_H
+
+/* T after dt seconds with `power` W going in */
+double predict_temperature(double T_curr, double power, double Tamb,
+                           double R, double C, double dt);
+
+/* T after `t` seconds at constant `power` (closed form) */
+double project_temperature(double T_curr, double power, double Tamb,
+                           double R, double C, double t);
+
+/*
+ * R with fans at `cooling` (0..1): full cooling scales it by
+ * `r_factor`, linearly in between
+ */
+double effective_resistance(double R, double r_factor, double cooling);
+
+/* Share of `power` to remove for the next step to land on T_target */
+double idle_fraction_for_target(double T_curr, double power,
+                                double T_target, double Tamb,
+                                double R, double C, double dt);
+
+#endif
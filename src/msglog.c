@@ -0,0 +1,95 @@
+/*
+ * Console messages from the control loop
+ *
+ * Same single-producer/single-consumer scheme as spsc_ring.h, with
+ * text lines for records. The producer signals an eventfd instead of
+ * a futex so the main thread can wait for it in its epoll set; the
+ * write is non-blocking and only fails once the counter saturates,
+ * in which case the main loop is already due to drain.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "msglog.h"
+
+static struct {
+    atomic_uint head;               // next slot to fill
+    atomic_uint tail;               // next slot to drain
+    atomic_uint drops;
+    char lines[MSGLOG_SLOTS][MSGLOG_LINE];
+} ring;
+
+static int efd = -1;
+
+int msglog_open(void)
+{
+    efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return efd;
+}
+
+void msglog_printf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+
+    if (efd < 0) {
+        vprintf(fmt, ap);
+        va_end(ap);
+        return;
+    }
+
+    unsigned h = atomic_load_explicit(&ring.head, memory_order_relaxed);
+    unsigned t = atomic_load_explicit(&ring.tail, memory_order_acquire);
+    if (h - t >= MSGLOG_SLOTS) {
+        atomic_fetch_add_explicit(&ring.drops, 1, memory_order_relaxed);
+        va_end(ap);
+        return;
+    }
+
+    vsnprintf(ring.lines[h & (MSGLOG_SLOTS - 1)], MSGLOG_LINE, fmt, ap);
+    va_end(ap);
+    atomic_store_explicit(&ring.head, h + 1, memory_order_release);
+
+    uint64_t one = 1;
+    if (write(efd, &one, sizeof(one)) < 0) {
+        /* saturated: the main loop has a wakeup pending already */
+    }
+}
+
+void msglog_drain(void)
+{
+    uint64_t n;
+
+    /* Reset the counter first so a line queued meanwhile re-arms it */
+    if (efd >= 0 && read(efd, &n, sizeof(n)) < 0) {
+        /* nothing signalled; the ring may still hold lines */
+    }
+
+    unsigned t = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+    unsigned h = atomic_load_explicit(&ring.head, memory_order_acquire);
+    while (t != h) {
+        fputs(ring.lines[t & (MSGLOG_SLOTS - 1)], stdout);
+        atomic_store_explicit(&ring.tail, ++t, memory_order_release);
+    }
+
+    unsigned d = atomic_exchange_explicit(&ring.drops, 0,
+                                          memory_order_relaxed);
+    if (d)
+        printf("(%u console message(s) dropped)\n", d);
+    fflush(stdout);
+}
+
+void msglog_close(void)
+{
+    if (efd < 0)
+        return;
+
+    msglog_drain();
+    close(efd);
+    efd = -1;
+}
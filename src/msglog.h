@@ -0,0 +1,36 @@
+/*
+ * Console messages from the control loop
+ *
+ * The actuator runs SCHED_FIFO and must not wait on a slow or stopped
+ * terminal, so while the main loop has the log open its lines go
+ * through a ring that the main thread drains. Otherwise (replay,
+ * simulation, start-up and shutdown) they are printed straight away.
+ */
+
+#ifndef RC_MSGLOG_H
+#define RC_MSGLOG_H
+
+#define MSGLOG_SLOTS    64      // power of two
+#define MSGLOG_LINE     512     // longer messages are truncated
+
+/*
+ * Start queueing; returns an eventfd that becomes readable when there
+ * are lines to drain, -1 on failure (messages keep being printed)
+ */
+int msglog_open(void);
+
+/*
+ * Print or queue one message, newline included. Never blocks; a full
+ * ring drops the message and counts it. One producer at a time: the
+ * actuator thread while the pipeline runs.
+ */
+void msglog_printf(const char *fmt, ...)
+    __attribute__((format(printf, 1, 2)));
+
+/* Main thread: print every queued line, and how many were dropped */
+void msglog_drain(void);
+
+/* Drain what is left and go back to printing directly */
+void msglog_close(void);
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ * Controller parameters: defaults, validation and the config file
+ *
+ * File format: one "key = value" per line, '#' starts a comment.
+ * Keys are the struct rc_params field names.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <limits.h>
+#include <math.h>
+
+#include "params.h"
+
+const struct rc_params params_builtin = {
+    .r_thermal       = DEFAULT_R_THERMAL,
+    .c_thermal       = DEFAULT_C_THERMAL,
+    .t_ambient       = DEFAULT_T_AMBIENT,
+    .dt              = DEFAULT_DT,
+    .t_high          = DEFAULT_T_HIGH,
+    .t_low           = DEFAULT_T_LOW,
+    .t_critical      = DEFAULT_T_CRITICAL,
+    .trip_auto       = DEFAULT_TRIP_AUTO,
+    .trip_high_offset     = DEFAULT_TRIP_HIGH_OFFSET,
+    .trip_critical_offset = DEFAULT_TRIP_CRITICAL_OFFSET,
+    .alpha           = DEFAULT_ALPHA,
+    .action_cooldown = DEFAULT_ACTION_COOLDOWN,
+    .cap_factor      = DEFAULT_CAP_FACTOR,
+    .fan_r_factor    = DEFAULT_FAN_R_FACTOR,
+    .fan_step        = DEFAULT_FAN_STEP,
+    .sensor_stale_reads = DEFAULT_SENSOR_STALE_READS,
+    .sensor_stuck_time  = DEFAULT_SENSOR_STUCK_TIME,
+    .sensor_stuck_delta = DEFAULT_SENSOR_STUCK_DELTA,
+    .ramp_drift      = DEFAULT_RAMP_DRIFT,
+    .ramp_threshold  = DEFAULT_RAMP_THRESHOLD,
+    .ramp_horizon    = DEFAULT_RAMP_HORIZON,
+    .ramp_cap_factor = DEFAULT_RAMP_CAP_FACTOR,
+    .generation      = 0,
+};
+
+static const struct {
+    const char *key;
+    size_t off;
+} keys[] = {
+    { "r_thermal",       offsetof(struct rc_params, r_thermal) },
+    { "c_thermal",       offsetof(struct rc_params, c_thermal) },
+    { "t_ambient",       offsetof(struct rc_params, t_ambient) },
+    { "dt",              offsetof(struct rc_params, dt) },
+    { "t_high",          offsetof(struct rc_params, t_high) },
+    { "t_low",           offsetof(struct rc_params, t_low) },
+    { "t_critical",      offsetof(struct rc_params, t_critical) },
+    { "trip_auto",       offsetof(struct rc_params, trip_auto) },
+    { "trip_high_offset", offsetof(struct rc_params, trip_high_offset) },
+    { "trip_critical_offset",
+      offsetof(struct rc_params, trip_critical_offset) },
+    { "alpha",           offsetof(struct rc_params, alpha) },
+    { "action_cooldown", offsetof(struct rc_params, action_cooldown) },
+    { "cap_factor",      offsetof(struct rc_params, cap_factor) },
+    { "fan_r_factor",    offsetof(struct rc_params, fan_r_factor) },
+    { "fan_step",        offsetof(struct rc_params, fan_step) },
+    { "sensor_stale_reads",
+      offsetof(struct rc_params, sensor_stale_reads) },
+    { "sensor_stuck_time", offsetof(struct rc_params, sensor_stuck_time) },
+    { "sensor_stuck_delta",
+      offsetof(struct rc_params, sensor_stuck_delta) },
+    { "ramp_drift",      offsetof(struct rc_params, ramp_drift) },
+    { "ramp_threshold",  offsetof(struct rc_params, ramp_threshold) },
+    { "ramp_horizon",    offsetof(struct rc_params, ramp_horizon) },
+    { "ramp_cap_factor", offsetof(struct rc_params, ramp_cap_factor) },
+};
+
+void params_defaults(struct rc_params *p)
+{
+    *p = params_builtin;
+}
+
+static char *trim(char *s)
+{
+    while (isspace((unsigned char)*s))
+        s++;
+
+    char *end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+
+    return s;
+}
+
+int params_validate(const struct rc_params *p, char *err, size_t errlen)
+{
+    if (p->r_thermal <= 0 || p->c_thermal <= 0 || p->dt <= 0) {
+        snprintf(err, errlen, "r_thermal, c_thermal and dt must be > 0");
+        return -1;
+    }
+    if (!(p->t_low < p->t_high && p->t_high < p->t_critical)) {
+        snprintf(err, errlen, "need t_low < t_high < t_critical");
+        return -1;
+    }
+    if (p->trip_auto != 0 && p->trip_auto != 1) {
+        snprintf(err, errlen, "trip_auto must be 0 or 1");
+        return -1;
+    }
+    if (p->trip_high_offset < 0 || p->trip_critical_offset < 0) {
+        snprintf(err, errlen, "trip offsets must be >= 0");
+        return -1;
+    }
+    if (p->alpha < 0 || p->action_cooldown < 0) {
+        snprintf(err, errlen, "alpha and action_cooldown must be >= 0");
+        return -1;
+    }
+    if (p->cap_factor <= 0 || p->cap_factor > 1) {
+        snprintf(err, errlen, "cap_factor must be in (0, 1]");
+        return -1;
+    }
+    if (p->fan_r_factor <= 0 || p->fan_r_factor > 1 ||
+        p->fan_step <= 0 || p->fan_step > 1) {
+        snprintf(err, errlen, "fan_r_factor and fan_step must be in (0, 1]");
+        return -1;
+    }
+    /* range-checked before rct_sample() casts it to unsigned */
+    if (!isfinite(p->sensor_stale_reads) || p->sensor_stale_reads < 0 ||
+        p->sensor_stale_reads > UINT_MAX ||
+        p->sensor_stale_reads != floor(p->sensor_stale_reads)) {
+        snprintf(err, errlen, "sensor_stale_reads must be a whole number "
+                 "in [0, %u]", UINT_MAX);
+        return -1;
+    }
+    if (!isfinite(p->sensor_stuck_time) || p->sensor_stuck_time <= 0 ||
+        !isfinite(p->sensor_stuck_delta) || p->sensor_stuck_delta <= 0) {
+        snprintf(err, errlen, "sensor_stuck_time and sensor_stuck_delta "
+                 "must be > 0");
+        return -1;
+    }
+    if (p->ramp_drift < 0 || p->ramp_threshold < 0 || p->ramp_horizon <= 0) {
+        snprintf(err, errlen, "ramp_drift and ramp_threshold must be >= 0, "
+                 "ramp_horizon > 0");
+        return -1;
+    }
+    if (p->ramp_cap_factor < p->cap_factor || p->ramp_cap_factor > 1) {
+        snprintf(err, errlen, "ramp_cap_factor must be in [cap_factor, 1]");
+        return -1;
+    }
+    return 0;
+}
+
+int params_set_key(struct rc_params *p, const char *key, double value)
+{
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        if (strcmp(keys[i].key, key) == 0) {
+            *(double *)((char *)p + keys[i].off) = value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int params_parse(const char *path, struct rc_params *p,
+                 char *err, size_t errlen)
+{
+    params_defaults(p);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        int e = errno;
+        snprintf(err, errlen, "%s: %s", path, strerror(e));
+        errno = e;
+        return -1;
+    }
+
+    char line[256];
+    int lineno = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        lineno++;
+        line[strcspn(line, "#\n")] = '\0';
+
+        char *key = trim(line);
+        if (!*key)
+            continue;
+
+        char *eq = strchr(key, '=');
+        if (!eq) {
+            snprintf(err, errlen, "%s:%d: expected key = value",
+                     path, lineno);
+            fclose(fp);
+            return -1;
+        }
+        *eq = '\0';
+        key = trim(key);
+        char *val = trim(eq + 1);
+
+        char *end;
+        double v = strtod(val, &end);
+        if (end == val || *end) {
+            snprintf(err, errlen, "%s:%d: bad number '%s'",
+                     path, lineno, val);
+            fclose(fp);
+            return -1;
+        }
+
+        if (params_set_key(p, key, v) < 0) {
+            snprintf(err, errlen, "%s:%d: unknown key '%s'",
+                     path, lineno, key);
+            fclose(fp);
+            return -1;
+        }
+    }
+
+    fclose(fp);
+    return params_validate(p, err, errlen);
+}
@@ -0,0 +1,113 @@
+/*
+ * Controller parameters: defaults, validation and the config file
+ *
+ * All tunables live in one flat struct that is passed to every model
+ * and controller call, so instances with different parameters can run
+ * side by side. The daemon's live copy is managed by config.h.
+ */
+
+#ifndef RC_PARAMS_H
+#define RC_PARAMS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* =======================
+   RC MODEL DEFAULTS
+   ======================= */
+#define DEFAULT_R_THERMAL   1.0
+#define DEFAULT_C_THERMAL   10.0
+#define DEFAULT_T_AMBIENT   30.0
+#define DEFAULT_DT          1.0
+
+/* =======================
+   HYSTERESIS DEFAULTS
+   ======================= */
+#define DEFAULT_T_HIGH      75.0
+#define DEFAULT_T_LOW       70.0
+#define DEFAULT_T_CRITICAL  85.0
+
+/* =======================
+   TRIP POINT DEFAULTS
+   ======================= */
+#define DEFAULT_TRIP_AUTO            1      // thresholds from the zone's trips
+#define DEFAULT_TRIP_HIGH_OFFSET     5.0    // t_high, °C below passive
+#define DEFAULT_TRIP_CRITICAL_OFFSET 10.0   // t_critical, °C below critical
+
+/* =======================
+   POWER MODEL DEFAULTS
+   ======================= */
+#define DEFAULT_ALPHA       5.0
+
+/* =======================
+   SAFETY DEFAULTS
+   ======================= */
+#define DEFAULT_ACTION_COOLDOWN 5.0     // seconds between mitigation actions
+#define DEFAULT_CAP_FACTOR      0.7     // share of max freq kept when capped
+
+/* =======================
+   FAN DEFAULTS
+   ======================= */
+#define DEFAULT_FAN_R_FACTOR    0.6     // R at full fan, share of r_thermal
+#define DEFAULT_FAN_STEP        0.25    // fan level change per action
+
+/* =======================
+   SENSOR HEALTH DEFAULTS
+   ======================= */
+#define DEFAULT_SENSOR_STALE_READS  3       // held reads before invalid
+#define DEFAULT_SENSOR_STUCK_TIME   60.0    // s a frozen value is given
+#define DEFAULT_SENSOR_STUCK_DELTA  3.0     // °C the model must move by
+
+/* =======================
+   RAMP DETECTION DEFAULTS
+   ======================= */
+#define DEFAULT_RAMP_DRIFT      1.0     // W of power rise ignored
+#define DEFAULT_RAMP_THRESHOLD  4.0     // W*s of rise that makes a ramp
+#define DEFAULT_RAMP_HORIZON    30.0    // s the model is projected ahead
+#define DEFAULT_RAMP_CAP_FACTOR 0.9     // early cap, 1 disables
+
+struct rc_params {
+    double r_thermal;       // K/W
+    double c_thermal;       // J/K
+    double t_ambient;       // °C
+    double dt;              // prediction horizon, s
+    double t_high;
+    double t_low;
+    double t_critical;
+    double trip_auto;       // 1: per-zone thresholds from trip points
+    double trip_high_offset;     // °C below the passive trip
+    double trip_critical_offset; // °C below the critical trip
+    double alpha;           // W per GHz at full utilization
+    double action_cooldown; // s
+    double cap_factor;
+    double fan_r_factor;
+    double fan_step;        // 0..1
+    double sensor_stale_reads;   // reads a held value covers
+    double sensor_stuck_time;    // s
+    double sensor_stuck_delta;   // °C, above the sensor's resolution
+    double ramp_drift;      // W
+    double ramp_threshold;  // W*s
+    double ramp_horizon;    // s
+    double ramp_cap_factor;
+    uint64_t generation;    // bumped on every successful reload
+};
+
+/* The built-in set; params_defaults() copies it */
+extern const struct rc_params params_builtin;
+
+void params_defaults(struct rc_params *p);
+
+/* Set the field named `key` (a config file key); -1 if unknown */
+int params_set_key(struct rc_params *p, const char *key, double value);
+
+/* 0 if the set is usable, else -1 with `err` filled */
+int params_validate(const struct rc_params *p, char *err, size_t errlen);
+
+/*
+ * Parse `path` on top of the defaults. Unknown keys and inconsistent
+ * values reject the whole file. Returns 0 or -1 with `err` filled.
+ */
+int params_parse(const char *path, struct rc_params *p,
+                 char *err, size_t errlen);
+
+#endif
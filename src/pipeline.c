@@ -0,0 +1,314 @@
+/*
+ * Sampler -> model -> actuator pipeline
+ *
+ * The sampler is paced by an absolute timerfd schedule and never
+ * blocks on the rest of the pipeline: if a ring is full the record
+ * is dropped and counted. Latency counters are written by the owning
+ * stage only and read with relaxed loads by the control socket.
+ * Each stage charges its own CPU and syscall cost to the record it
+ * hands on, so the actuator sees the whole tick's overhead.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <sys/timerfd.h>
+
+#include "pipeline.h"
+#include "spsc_ring.h"
+#include "histogram.h"
+#include "config.h"
+#include "selfstat.h"
+
+struct lat_stat {
+    atomic_ullong count, total_ns, max_ns;
+};
+
+static struct spsc_ring ring_sm;    // sampler -> model
+static struct spsc_ring ring_ma;    // model -> actuator
+
+static struct {
+    struct lat_stat run, late;      // sensor read time, tick lateness
+    atomic_ullong missed;           // timer overruns
+    struct hist wakeup;             // tick lateness distribution
+} sampler_stats;
+
+static struct {
+    struct lat_stat run, wait;      // model time, time queued
+} model_stats;
+
+static struct {
+    struct lat_stat run, e2e;       // actuation time, tick-to-decision
+} actuator_stats;
+
+static const struct pipeline_ops *ops;
+static struct rt_config rt = { .prio = 0, .cpu = -1 };
+static uint64_t period_ns, start_ns;
+static int tfd = -1;
+static atomic_int stopping;
+static pthread_t threads[3];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Single writer: plain load/store instead of locked read-modify-write */
+static void lat_add(struct lat_stat *l, uint64_t ns)
+{
+    atomic_store_explicit(&l->count,
+        atomic_load_explicit(&l->count, memory_order_relaxed) + 1,
+        memory_order_relaxed);
+    atomic_store_explicit(&l->total_ns,
+        atomic_load_explicit(&l->total_ns, memory_order_relaxed) + ns,
+        memory_order_relaxed);
+    if (ns > atomic_load_explicit(&l->max_ns, memory_order_relaxed))
+        atomic_store_explicit(&l->max_ns, ns, memory_order_relaxed);
+}
+
+static void arm_timer(uint64_t first_ns)
+{
+    struct itimerspec its = {
+        .it_value    = { first_ns / 1000000000ULL,
+                         first_ns % 1000000000ULL },
+        .it_interval = { period_ns / 1000000000ULL,
+                         period_ns % 1000000000ULL },
+    };
+    timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/* The sampler gets the configured priority, later stages one less */
+static void stage_setup(int stage)
+{
+    params_quiescent();
+
+    if (rt.prio > 0) {
+        int prio = rt.prio - (stage > 0);
+        rt_setup_thread(prio > 0 ? prio : 1, rt.cpu);
+        rt_prefault_stack();
+    }
+    else if (rt.cpu >= 0) {
+        rt_setup_thread(0, rt.cpu);
+    }
+
+    selfstat_thread_init();
+}
+
+static void *sampler_main(void *arg)
+{
+    (void)arg;
+    uint64_t ticks = 0;
+
+    stage_setup(0);
+
+    while (!atomic_load_explicit(&stopping, memory_order_relaxed)) {
+        uint64_t exp;
+        if (read(tfd, &exp, sizeof(exp)) != sizeof(exp))
+            continue;
+        if (atomic_load_explicit(&stopping, memory_order_relaxed))
+            break;
+
+        ticks += exp;
+        if (exp > 1)
+            atomic_store_explicit(&sampler_stats.missed,
+                atomic_load_explicit(&sampler_stats.missed,
+                                     memory_order_relaxed) + exp - 1,
+                memory_order_relaxed);
+
+        struct sample_rec rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.seq = ticks;
+        rec.t_due_ns = start_ns + (ticks - 1) * period_ns;
+
+        uint64_t t0 = now_ns();
+        ops->sample(&rec);
+        rec.t_sample_ns = now_ns();
+
+        uint64_t late = t0 > rec.t_due_ns ? t0 - rec.t_due_ns : 0;
+        lat_add(&sampler_stats.late, late);
+        hist_record(&sampler_stats.wakeup, late);
+        lat_add(&sampler_stats.run, rec.t_sample_ns - t0);
+
+        selfstat_charge(&rec);
+        ring_push(&ring_sm, &rec);
+        params_quiescent();
+    }
+
+    ring_close(&ring_sm);
+    return NULL;
+}
+
+static void *model_main(void *arg)
+{
+    (void)arg;
+    struct sample_rec rec;
+
+    stage_setup(1);
+
+    while (ring_pop(&ring_sm, &rec)) {
+        uint64_t t0 = now_ns();
+        ops->model(&rec);
+        rec.t_model_ns = now_ns();
+
+        lat_add(&model_stats.wait, t0 - rec.t_sample_ns);
+        lat_add(&model_stats.run, rec.t_model_ns - t0);
+
+        selfstat_charge(&rec);
+        ring_push(&ring_ma, &rec);
+        params_quiescent();
+    }
+
+    ring_close(&ring_ma);
+    return NULL;
+}
+
+static void *actuator_main(void *arg)
+{
+    (void)arg;
+    struct sample_rec rec;
+
+    stage_setup(2);
+
+    while (ring_pop(&ring_ma, &rec)) {
+        uint64_t t0 = now_ns();
+        ops->actuate(&rec);
+        uint64_t t1 = now_ns();
+
+        lat_add(&actuator_stats.run, t1 - t0);
+        lat_add(&actuator_stats.e2e, t1 - rec.t_due_ns);
+
+        selfstat_charge(&rec);
+        selfstat_tick(&rec);
+        params_quiescent();
+    }
+
+    return NULL;
+}
+
+int pipeline_start(const struct pipeline_ops *o, uint64_t period,
+                   const struct rt_config *rtc)
+{
+    static void *(*const mains[3])(void *) = {
+        sampler_main, model_main, actuator_main
+    };
+    static const char *const names[3] = {
+        "rc-sampler", "rc-model", "rc-actuator"
+    };
+
+    ops = o;
+    period_ns = period;
+    if (rtc)
+        rt = *rtc;
+
+    tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0)
+        return -1;
+
+    start_ns = now_ns();
+    arm_timer(start_ns);
+
+    /* Under mlockall the default 8 MB stacks would all be resident */
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (rt.prio > 0)
+        pthread_attr_setstacksize(&attr, RT_THREAD_STACK);
+
+    for (int i = 0; i < 3; i++) {
+        if (pthread_create(&threads[i], &attr, mains[i], NULL) != 0) {
+            pthread_attr_destroy(&attr);
+            return -1;
+        }
+        pthread_setname_np(threads[i], names[i]);
+    }
+    pthread_attr_destroy(&attr);
+
+    return 0;
+}
+
+void pipeline_stop(void)
+{
+    if (tfd < 0)
+        return;
+
+    /* Fire the timer now so the sampler notices without a full period */
+    atomic_store(&stopping, 1);
+    arm_timer(now_ns());
+
+    for (int i = 0; i < 3; i++)
+        pthread_join(threads[i], NULL);
+
+    close(tfd);
+    tfd = -1;
+}
+
+static void report_lat(struct ctl_reply *r, const char *stage,
+                       const char *what, struct lat_stat *l)
+{
+    unsigned long long n = atomic_load_explicit(&l->count,
+                                                memory_order_relaxed);
+    unsigned long long total = atomic_load_explicit(&l->total_ns,
+                                                    memory_order_relaxed);
+    unsigned long long max = atomic_load_explicit(&l->max_ns,
+                                                  memory_order_relaxed);
+
+    ctl_printf(r, "%-9s %-5s %10llu %12.1f %12.1f\n", stage, what, n,
+               n ? total / (double)n / 1e3 : 0.0, max / 1e3);
+}
+
+static void report_ring(struct ctl_reply *r, const char *name,
+                        struct spsc_ring *ring)
+{
+    ctl_printf(r, "%-9s depth=%u max_depth=%u drops=%u capacity=%d\n",
+               name, ring_depth(ring),
+               atomic_load_explicit(&ring->max_depth, memory_order_relaxed),
+               atomic_load_explicit(&ring->drops, memory_order_relaxed),
+               RING_SLOTS);
+}
+
+void pipeline_report(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+
+    ctl_printf(r, "period_us=%.1f missed_ticks=%llu\n", period_ns / 1e3,
+               (unsigned long long)atomic_load_explicit(
+                   &sampler_stats.missed, memory_order_relaxed));
+    ctl_printf(r, "%-9s %-5s %10s %12s %12s\n",
+               "stage", "what", "count", "avg_us", "max_us");
+    report_lat(r, "sampler", "late", &sampler_stats.late);
+    report_lat(r, "sampler", "run", &sampler_stats.run);
+    report_lat(r, "model", "wait", &model_stats.wait);
+    report_lat(r, "model", "run", &model_stats.run);
+    report_lat(r, "actuator", "run", &actuator_stats.run);
+    report_lat(r, "actuator", "e2e", &actuator_stats.e2e);
+    report_ring(r, "sm_ring", &ring_sm);
+    report_ring(r, "ma_ring", &ring_ma);
+}
+
+void pipeline_jitter(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+    struct hist *h = &sampler_stats.wakeup;
+
+    ctl_printf(r, "rt_prio=%d rt_cpu=%d samples=%llu\n", rt.prio, rt.cpu,
+               (unsigned long long)atomic_load_explicit(
+                   &h->total, memory_order_relaxed));
+    ctl_printf(r, "p50_us=%.1f p90_us=%.1f p99_us=%.1f p999_us=%.1f "
+               "max_us=%.1f\n",
+               hist_quantile(h, 0.50) / 1e3, hist_quantile(h, 0.90) / 1e3,
+               hist_quantile(h, 0.99) / 1e3, hist_quantile(h, 0.999) / 1e3,
+               atomic_load_explicit(&h->max, memory_order_relaxed) / 1e3);
+
+    /* Non-empty buckets: lower bound and count */
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        unsigned long long n =
+            atomic_load_explicit(&h->bucket[i], memory_order_relaxed);
+        if (n)
+            ctl_printf(r, ">=%.3f_us %llu\n", hist_bucket_low(i) / 1e3, n);
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * Sampler -> model -> actuator pipeline
+ *
+ * Three threads joined by SPSC rings, so a slow sysfs write in the
+ * actuator never delays the next sample. The stage functions are the
+ * same ones a serial loop would call, in the same order.
+ */
+
+#ifndef RC_PIPELINE_H
+#define RC_PIPELINE_H
+
+#include <stdint.h>
+
+#include "sample.h"
+#include "control.h"
+#include "rt.h"
+
+struct pipeline_ops {
+    void (*sample)(struct sample_rec *r);       // fill T_curr, freq, util
+    void (*model)(struct sample_rec *r);        // fill power, T_pred
+    void (*actuate)(const struct sample_rec *r);
+};
+
+/*
+ * Start the threads; the first sample is taken immediately.
+ * `rt` may be NULL for plain SCHED_OTHER threads.
+ */
+int pipeline_start(const struct pipeline_ops *ops, uint64_t period_ns,
+                   const struct rt_config *rt);
+
+/* Stop sampling, drain both rings and join the threads */
+void pipeline_stop(void);
+
+/* Per-stage latency and queue depth, for the control socket */
+void pipeline_report(const char *args, struct ctl_reply *r);
+
+/* Wakeup lateness histogram of the sampler */
+void pipeline_jitter(const char *args, struct ctl_reply *r);
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Sensor and cpufreq access used by the control stages
+ *
+ * Every call carries the backend's own context, so one process can
+ * drive several policies (or a mix of real and simulated ones) with
+ * separate controllers. sysfs.h is the real backend; replay and the
+ * simulator install tables that run on a virtual clock.
+ */
+
+#ifndef RC_PLATFORM_H
+#define RC_PLATFORM_H
+
+struct platform_ops {
+    double (*read_temperature)(void *ctx);      // °C, < 0 on failure
+    double (*read_frequency)(void *ctx);        // GHz, < 0 on failure
+    double (*read_utilization)(void *ctx);      // 0..1
+    int    (*read_max_frequency)(void *ctx);    // kHz, <= 0 on failure
+    void   (*write_max_frequency)(void *ctx, int khz);
+    int    (*restore_max_frequency)(void *ctx); // 0, or -1: nothing to restore
+    double (*now)(void *ctx);                   // seconds, monotonic
+};
+
+/* A backend instance */
+struct platform {
+    const struct platform_ops *ops;
+    void *ctx;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * Workload ramp detection
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "ramp.h"
+
+void ramp_reset(struct ramp *r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+int ramp_update(struct ramp *r, double t, double power, double drift,
+                double threshold)
+{
+    r->t[r->head] = t;
+    r->p[r->head] = power;
+    r->head = (r->head + 1) % RAMP_WINDOW;
+    if (r->n < RAMP_WINDOW)
+        r->n++;
+
+    if (r->n == 1) {
+        r->base = power;
+        r->last_t = t;
+        return 0;
+    }
+
+    double dt = t - r->last_t;
+    r->last_t = t;
+    if (dt <= 0.0)
+        return r->active;
+
+    r->cusum += (power - r->base - drift) * dt;
+    if (r->cusum < 0.0)
+        r->cusum = 0.0;
+    r->active = r->cusum > threshold;
+
+    /* The baseline lags on purpose: it is what a ramp is measured from */
+    r->base += (power - r->base) * (1.0 - exp(-dt / RAMP_BASE_TAU));
+
+    return r->active;
+}
+
+/* Least-squares line through the window: slope and value at the newest */
+static void fit(const struct ramp *r, double *slope, double *level)
+{
+    double st = 0, sp = 0, stt = 0, stp = 0;
+    unsigned newest = (r->head + RAMP_WINDOW - 1) % RAMP_WINDOW;
+    double t0 = r->t[newest];
+
+    for (unsigned i = 0; i < r->n; i++) {
+        double t = r->t[i] - t0, p = r->p[i];
+        st += t;
+        sp += p;
+        stt += t * t;
+        stp += t * p;
+    }
+
+    double den = r->n * stt - st * st;
+    *slope = r->n > 1 && den > 0.0 ? (r->n * stp - st * sp) / den : 0.0;
+    *level = (sp - *slope * st) / (r->n ? r->n : 1);
+}
+
+double ramp_slope(const struct ramp *r)
+{
+    double slope, level;
+    fit(r, &slope, &level);
+    return slope;
+}
+
+double ramp_level(const struct ramp *r)
+{
+    double slope, level;
+    fit(r, &slope, &level);
+
+    /* After a step the line still leans on the samples before it */
+    double newest = r->p[(r->head + RAMP_WINDOW - 1) % RAMP_WINDOW];
+    return newest > level ? newest : level;
+}
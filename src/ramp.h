@@ -0,0 +1,41 @@
+/*
+ * Workload ramp detection
+ *
+ * An upward CUSUM of power over a slow moving baseline: every sample
+ * adds (P - baseline - drift) * dt, floored at zero, and a ramp is
+ * flagged while the sum exceeds `threshold`. A step of dP watts is
+ * therefore seen after about threshold / (dP - drift) seconds whatever
+ * the sampling rate, while noise below `drift` never accumulates. A
+ * least-squares fit over the last RAMP_WINDOW samples gives the slope
+ * and the level the ramp has reached.
+ */
+
+#ifndef RC_RAMP_H
+#define RC_RAMP_H
+
+#define RAMP_WINDOW     8
+#define RAMP_BASE_TAU   60.0        // s, time constant of the baseline
+
+struct ramp {
+    double base;                    // slow EWMA of power, W
+    double cusum;                   // W*s above base + drift
+    double last_t;
+    double t[RAMP_WINDOW], p[RAMP_WINDOW];
+    unsigned n, head;
+    int active;
+};
+
+void ramp_reset(struct ramp *r);
+
+/* Feed the power estimate at time t (s); returns 1 while ramping */
+int ramp_update(struct ramp *r, double t, double power, double drift,
+                double threshold);
+
+/* W/s over the window */
+double ramp_slope(const struct ramp *r);
+
+/* Power the ramp has reached: the fit at the newest sample, or that
+   sample itself if higher, W */
+double ramp_level(const struct ramp *r);
+
+#endif
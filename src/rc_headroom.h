@@ -0,0 +1,111 @@
+/*
+ * rc_sched thermal headroom: layout and client API
+ *
+ * After every control decision the daemon publishes how much power
+ * could be added before the RC model reaches T_HIGH, together with
+ * the model state it was derived from, in one page under /dev/shm.
+ * Cooperative applications read it to size their work (shrink a
+ * thread pool, defer a batch) instead of being capped blindly.
+ *
+ * The data block is guarded by a sequence counter like the telemetry
+ * page. The same counter is a futex word: the writer wakes it after
+ * every publish, so rc_headroom_wait() sleeps in the kernel until a
+ * new decision arrives. Clients map the page read-only.
+ *
+ * Clients link rc_headroom_client.c (and -lm); no other daemon code.
+ */
+
+#ifndef RC_HEADROOM_H
+#define RC_HEADROOM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <math.h>
+
+#define RC_HEADROOM_PATH    "/dev/shm/rc_sched.headroom"
+#define RC_HEADROOM_MAGIC   0x4d525248u     // "HRRM"
+#define RC_HEADROOM_VERSION 1
+
+struct rc_headroom_data {
+    uint64_t sample_seq;
+    int64_t  t_wall_ns;         // CLOCK_REALTIME at publish
+    uint32_t valid;             // sensors read successfully
+    uint32_t mitigation_level;  // RC_TELEM_MIT_*: 0 = not limited
+    double temp_c;
+    double power_w;             // model power estimate
+    double watts;               // extra power sustainable indefinitely
+                                // (negative: load must shed this much)
+    double seconds;             // to T_HIGH at current power, INFINITY
+                                // if it is never reached
+    /* model, for rc_headroom_seconds() / rc_headroom_watts() */
+    double t_high;
+    double t_ambient;
+    double r_thermal;           // K/W
+    double c_thermal;           // J/K
+};
+
+struct rc_headroom_page {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              // sizeof(struct rc_headroom_page)
+    uint32_t writer_pid;
+    _Alignas(64) atomic_uint seq;       // seqlock and futex word
+    _Alignas(64) struct rc_headroom_data data;
+};
+
+/*
+ * Seconds until T_HIGH if `extra_w` is added to the current load,
+ * 0 if already there, INFINITY if the new steady state stays below.
+ */
+static inline double rc_headroom_seconds(const struct rc_headroom_data *d,
+                                         double extra_w)
+{
+    double T_ss = d->t_ambient + (d->power_w + extra_w) * d->r_thermal;
+
+    if (d->temp_c >= d->t_high)
+        return 0.0;
+    if (T_ss <= d->t_high)
+        return INFINITY;
+    return d->r_thermal * d->c_thermal *
+           log((T_ss - d->temp_c) / (T_ss - d->t_high));
+}
+
+/*
+ * Extra watts that can be added for `seconds` (INFINITY: for good)
+ * before T_HIGH is reached. Negative when the load has to shed power.
+ */
+static inline double rc_headroom_watts(const struct rc_headroom_data *d,
+                                       double seconds)
+{
+    if (!(seconds > 0.0))
+        return INFINITY;
+    if (isinf(seconds))
+        return (d->t_high - d->t_ambient) / d->r_thermal - d->power_w;
+
+    double e = exp(-seconds / (d->r_thermal * d->c_thermal));
+    double T_ss = (d->t_high - d->temp_c * e) / (1.0 - e);
+
+    return (T_ss - d->t_ambient) / d->r_thermal - d->power_w;
+}
+
+struct rc_headroom;             /* opaque client handle */
+
+/* Map the headroom page read-only; NULL if absent or incompatible */
+struct rc_headroom *rc_headroom_open(const char *path);
+
+/* Consistent snapshot: 0, or -1 if the writer is stuck mid-update */
+int rc_headroom_read(struct rc_headroom *h, struct rc_headroom_data *out);
+
+/*
+ * Block until the daemon reports that `extra_w` more watts can run for
+ * `seconds` (INFINITY: indefinitely) without reaching T_HIGH and no
+ * mitigation is in force. timeout_ms < 0 waits forever. Returns 0 with
+ * the satisfying snapshot in `out` (may be NULL), or -1 with errno
+ * ETIMEDOUT. If the daemon stops, only the timeout ends the wait.
+ */
+int rc_headroom_wait(struct rc_headroom *h, double extra_w, double seconds,
+                     int timeout_ms, struct rc_headroom_data *out);
+
+void rc_headroom_close(struct rc_headroom *h);
+
+#endif
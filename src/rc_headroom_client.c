@@ -0,0 +1,142 @@
+/*
+ * rc_sched thermal headroom: client side
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "rc_headroom.h"
+#include "seqlock.h"
+
+#define READ_RETRIES    1000
+#define READ_SPINS      64      // then yield: the writer may be preempted
+
+struct rc_headroom {
+    struct rc_headroom_page *page;
+};
+
+struct rc_headroom *rc_headroom_open(const char *path)
+{
+    int fd = open(path ? path : RC_HEADROOM_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    void *p = mmap(NULL, sizeof(struct rc_headroom_page), PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    struct rc_headroom_page *page = p;
+    if (page->magic != RC_HEADROOM_MAGIC ||
+        page->version != RC_HEADROOM_VERSION ||
+        page->size != sizeof(*page)) {
+        munmap(p, sizeof(*page));
+        return NULL;
+    }
+
+    struct rc_headroom *h = malloc(sizeof(*h));
+    if (!h) {
+        munmap(p, sizeof(*page));
+        return NULL;
+    }
+    h->page = page;
+
+    return h;
+}
+
+/* Snapshot and the counter value it was taken at */
+static int read_at(struct rc_headroom *h, struct rc_headroom_data *out,
+                   unsigned *seq)
+{
+    for (int i = 0; i < READ_RETRIES; i++) {
+        if (i >= READ_SPINS)
+            sched_yield();
+
+        unsigned s = atomic_load_explicit(&h->page->seq,
+                                          memory_order_acquire);
+        if (s & 1)
+            continue;
+
+        memcpy(out, &h->page->data, sizeof(*out));
+
+        if (!seq_read_retry(&h->page->seq, s)) {
+            *seq = s;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int rc_headroom_read(struct rc_headroom *h, struct rc_headroom_data *out)
+{
+    unsigned seq;
+    return read_at(h, out, &seq);
+}
+
+static int satisfied(const struct rc_headroom_data *d, double extra_w,
+                     double seconds)
+{
+    return d->valid && d->mitigation_level == 0 &&
+           rc_headroom_watts(d, seconds) >= extra_w;
+}
+
+static int64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int rc_headroom_wait(struct rc_headroom *h, double extra_w, double seconds,
+                     int timeout_ms, struct rc_headroom_data *out)
+{
+    int64_t deadline = timeout_ms < 0 ? 0 :
+                       mono_ns() + (int64_t)timeout_ms * 1000000LL;
+    struct rc_headroom_data d;
+    unsigned seq;
+
+    for (;;) {
+        int ok = read_at(h, &d, &seq) == 0;
+        if (ok && satisfied(&d, extra_w, seconds)) {
+            if (out)
+                *out = d;
+            return 0;
+        }
+        if (!ok)
+            seq = atomic_load_explicit(&h->page->seq, memory_order_acquire);
+
+        struct timespec rel, *tp = NULL;
+        if (timeout_ms >= 0) {
+            int64_t left = deadline - mono_ns();
+            if (left <= 0) {
+                errno = ETIMEDOUT;
+                return -1;
+            }
+            rel.tv_sec = left / 1000000000LL;
+            rel.tv_nsec = left % 1000000000LL;
+            tp = &rel;
+        }
+
+        /* Returns at once if a publish already moved the counter */
+        syscall(SYS_futex, &h->page->seq, FUTEX_WAIT, seq, tp, NULL, 0);
+    }
+}
+
+void rc_headroom_close(struct rc_headroom *h)
+{
+    if (!h)
+        return;
+    munmap(h->page, sizeof(*h->page));
+    free(h);
+}
@@ -0,0 +1,128 @@
+/*
+ * rc_sched binary sample log: on-disk format
+ *
+ * A pre-allocated file mapped into memory: one header page followed by
+ * a circular array of 16-byte slots. Most samples take one delta slot
+ * (changes since the previous sample, in fixed-point units). A key
+ * frame takes two slots and carries absolute values; one is written
+ * at least every REC_KEY_INTERVAL samples, whenever a delta would
+ * overflow, and whenever an actuator setting changes, so a reader can
+ * start decoding at any key frame after the oldest surviving slot.
+ *
+ * Units: temperatures in centi-°C, frequency in MHz, power in
+ * centi-W, time in µs, the applied cap in kHz as sysfs has it.
+ *
+ * Readers link rc_record_reader.c, which reconstructs samples.
+ */
+
+#ifndef RC_RECORD_H
+#define RC_RECORD_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define REC_MAGIC           0x47435352u     // "RSCG"
+#define REC_VERSION         1
+#define REC_HEADER_SIZE     4096
+#define REC_SLOT_SIZE       16
+#define REC_KEY_INTERVAL    1024
+
+/* kind */
+#define REC_DELTA           1
+#define REC_KEY             2
+#define REC_KEY2            3       // second half of a key frame
+
+/* flags */
+#define REC_F_VALID         0x01
+#define REC_F_MIT_MASK      0x06    // mitigation level << 1
+#define REC_F_MIT_SHIFT     1
+
+struct rec_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_size;
+    uint32_t pad;
+    uint64_t n_slots;
+    int64_t  wall_base_ns;          // CLOCK_REALTIME at mono_base_ns
+    int64_t  mono_base_ns;
+    _Alignas(64) atomic_ullong written;     // slots ever written
+};
+
+struct rec_delta {
+    uint8_t  kind;
+    uint8_t  flags;
+    uint8_t  util_pct;
+    uint8_t  idle_pct;
+    uint32_t dt_us;
+    int16_t  d_temp_cc;
+    int16_t  d_pred_cc;
+    int16_t  d_freq_mhz;
+    int16_t  d_power_cw;
+};
+
+struct rec_key {
+    uint8_t  kind;
+    uint8_t  flags;
+    uint8_t  util_pct;
+    uint8_t  idle_pct;
+    int16_t  temp_cc;
+    int16_t  pred_cc;
+    uint64_t t_us;                  // CLOCK_MONOTONIC
+};
+
+struct rec_key2 {
+    uint8_t  kind;
+    uint8_t  uclamp_pct;
+    uint16_t pad;
+    uint32_t freq_mhz;
+    int32_t  power_cw;
+    int32_t  cap_khz;               // -1 when uncapped
+};
+
+union rec_slot {
+    uint8_t kind;
+    struct rec_delta delta;
+    struct rec_key key;
+    struct rec_key2 key2;
+};
+
+_Static_assert(sizeof(union rec_slot) == REC_SLOT_SIZE, "slot size");
+_Static_assert(sizeof(struct rec_header) <= REC_HEADER_SIZE, "header");
+
+/* One reconstructed sample */
+struct rec_sample {
+    uint64_t t_us;                  // CLOCK_MONOTONIC of the writer
+    int64_t  wall_ns;               // CLOCK_REALTIME equivalent
+    int      valid;
+    int      mitigation_level;
+    double   temp_c;
+    double   pred_c;
+    double   freq_ghz;
+    double   power_w;
+    double   util;
+    int      idle_pct;
+    int      uclamp_pct;
+    int      cap_khz;
+};
+
+struct rec_reader;                  /* opaque */
+
+/* Map a log read-only; NULL (errno set) if absent or not a sample log */
+struct rec_reader *rec_reader_open(const char *path);
+
+/*
+ * Next sample, oldest first: 1, or 0 at the end of what was written
+ * when the reader was opened or last rewound. Starts at the first key
+ * frame after the oldest surviving slot.
+ */
+int rec_reader_next(struct rec_reader *r, struct rec_sample *out);
+
+void rec_reader_rewind(struct rec_reader *r);
+
+/* Slots ever written and slots the log holds */
+uint64_t rec_reader_written(const struct rec_reader *r);
+uint64_t rec_reader_capacity(const struct rec_reader *r);
+
+void rec_reader_close(struct rec_reader *r);
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * rc_sched binary sample log: reader side
+ *
+ * Works on a live log too; slots overwritten while reading show up as
+ * a resynchronisation at the next key frame.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rc_record.h"
+
+struct rec_reader {
+    void *map;
+    size_t map_size;
+    const struct rec_header *h;
+    const union rec_slot *slots;
+    uint64_t end;                   // written, as of open/rewind
+    uint64_t pos;
+    int synced;
+    struct {
+        uint64_t t_us;
+        int32_t temp_cc, pred_cc, freq_mhz, power_cw, cap_khz;
+        uint8_t flags, util_pct, idle_pct, uclamp_pct;
+    } s;
+};
+
+struct rec_reader *rec_reader_open(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < REC_HEADER_SIZE) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    const struct rec_header *h = p;
+    if (h->magic != REC_MAGIC || h->version != REC_VERSION ||
+        h->slot_size != REC_SLOT_SIZE || h->n_slots == 0 ||
+        REC_HEADER_SIZE + h->n_slots * REC_SLOT_SIZE > (uint64_t)st.st_size) {
+        munmap(p, st.st_size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct rec_reader *r = calloc(1, sizeof(*r));
+    if (!r) {
+        munmap(p, st.st_size);
+        return NULL;
+    }
+    r->map = p;
+    r->map_size = st.st_size;
+    r->h = h;
+    r->slots = (const union rec_slot *)((const char *)p + REC_HEADER_SIZE);
+    rec_reader_rewind(r);
+
+    return r;
+}
+
+void rec_reader_rewind(struct rec_reader *r)
+{
+    uint64_t n = r->h->n_slots;
+    r->end = atomic_load_explicit(&((struct rec_header *)r->h)->written,
+                                  memory_order_acquire);
+    r->pos = r->end > n ? r->end - n : 0;
+    r->synced = 0;
+}
+
+int rec_reader_next(struct rec_reader *r, struct rec_sample *out)
+{
+    uint64_t n = r->h->n_slots;
+
+    for (; r->pos < r->end; r->pos++) {
+        const union rec_slot *x = &r->slots[r->pos % n];
+
+        if (x->kind == REC_KEY && r->pos + 1 < r->end &&
+            r->slots[(r->pos + 1) % n].kind == REC_KEY2) {
+            const struct rec_key2 *k2 = &r->slots[(r->pos + 1) % n].key2;
+            r->s.t_us = x->key.t_us;
+            r->s.temp_cc = x->key.temp_cc;
+            r->s.pred_cc = x->key.pred_cc;
+            r->s.flags = x->key.flags;
+            r->s.util_pct = x->key.util_pct;
+            r->s.idle_pct = x->key.idle_pct;
+            r->s.freq_mhz = (int32_t)k2->freq_mhz;
+            r->s.power_cw = k2->power_cw;
+            r->s.cap_khz = k2->cap_khz;
+            r->s.uclamp_pct = k2->uclamp_pct;
+            r->synced = 1;
+            r->pos += 2;
+        }
+        else if (x->kind == REC_DELTA && r->synced) {
+            r->s.t_us += x->delta.dt_us;
+            r->s.temp_cc += x->delta.d_temp_cc;
+            r->s.pred_cc += x->delta.d_pred_cc;
+            r->s.freq_mhz += x->delta.d_freq_mhz;
+            r->s.power_cw += x->delta.d_power_cw;
+            r->s.flags = x->delta.flags;
+            r->s.util_pct = x->delta.util_pct;
+            r->s.idle_pct = x->delta.idle_pct;
+            r->pos++;
+        }
+        else {
+            r->synced = 0;      // wait for the next key frame
+            continue;
+        }
+
+        out->t_us = r->s.t_us;
+        out->wall_ns = r->h->wall_base_ns +
+                       ((int64_t)r->s.t_us * 1000 - r->h->mono_base_ns);
+        out->valid = r->s.flags & REC_F_VALID;
+        out->mitigation_level = (r->s.flags & REC_F_MIT_MASK) >>
+                                REC_F_MIT_SHIFT;
+        out->temp_c = r->s.temp_cc / 100.0;
+        out->pred_c = r->s.pred_cc / 100.0;
+        out->freq_ghz = r->s.freq_mhz / 1000.0;
+        out->power_w = r->s.power_cw / 100.0;
+        out->util = r->s.util_pct / 100.0;
+        out->idle_pct = r->s.idle_pct;
+        out->uclamp_pct = r->s.uclamp_pct;
+        out->cap_khz = r->s.cap_khz;
+        return 1;
+    }
+
+    return 0;
+}
+
+uint64_t rec_reader_written(const struct rec_reader *r)
+{
+    return r->end;
+}
+
+uint64_t rec_reader_capacity(const struct rec_reader *r)
+{
+    return r->h->n_slots;
+}
+
+void rec_reader_close(struct rec_reader *r)
+{
+    if (!r)
+        return;
+    munmap(r->map, r->map_size);
+    free(r);
+}
@@ -0,0 +1,73 @@
+/*
+ * rc_sched shared-memory telemetry: layout and reader API
+ *
+ * The daemon publishes its state into one page-aligned file under
+ * /dev/shm after every control decision. The data block is guarded by
+ * a sequence counter: readers copy it and retry if the counter was odd
+ * or moved, so a snapshot costs a few loads and no syscalls, and the
+ * writer never waits for readers.
+ *
+ * Readers link rc_telemetry_reader.c (no other daemon code needed).
+ */
+
+#ifndef RC_TELEMETRY_H
+#define RC_TELEMETRY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define RC_TELEM_PATH       "/dev/shm/rc_sched.telemetry"
+#define RC_TELEM_MAGIC      0x45544352u     // "RCTE"
+#define RC_TELEM_VERSION    1
+#define RC_TELEM_MAX_ZONES  16
+
+/* mitigation_level */
+#define RC_TELEM_MIT_NONE   0
+#define RC_TELEM_MIT_CAPPED 1       // frequency cap and/or uclamp
+#define RC_TELEM_MIT_IDLE   2       // plus forced idle injection
+
+struct rc_telem_zone {
+    double temp_c;
+    double pred_c;
+};
+
+struct rc_telem_data {
+    uint64_t sample_seq;        // pipeline tick number
+    uint64_t t_sample_ns;       // CLOCK_MONOTONIC when sensors were read
+    int64_t  t_wall_ns;         // CLOCK_REALTIME at publish
+    uint32_t valid;             // last sensor read succeeded
+    uint32_t mitigation_level;
+    double freq_ghz;
+    double util;
+    double power_w;
+    int32_t cap_khz;            // applied scaling_max_freq, -1 if none
+    int32_t original_khz;       // value it replaced, -1 if none
+    double uclamp_pct;          // 100 when not clamped
+    int32_t idle_pct;
+    uint32_t n_zones;
+    struct rc_telem_zone zones[RC_TELEM_MAX_ZONES];
+};
+
+struct rc_telem_page {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              // sizeof(struct rc_telem_page)
+    uint32_t writer_pid;
+    _Alignas(64) atomic_uint seq;
+    _Alignas(64) struct rc_telem_data data;
+};
+
+struct rc_telem;                /* opaque reader handle */
+
+/* Map the telemetry file read-only; NULL if absent or incompatible */
+struct rc_telem *rc_telem_open(const char *path);
+
+/*
+ * Take a consistent snapshot. Returns 0, or -1 if no snapshot could be
+ * taken within a bounded number of retries (writer stuck mid-update).
+ */
+int rc_telem_read(struct rc_telem *t, struct rc_telem_data *out);
+
+void rc_telem_close(struct rc_telem *t);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * rc_sched shared-memory telemetry: reader side
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "rc_telemetry.h"
+#include "seqlock.h"
+
+#define READ_RETRIES    1000
+#define READ_SPINS      64      // then yield: the writer may be preempted
+
+struct rc_telem {
+    struct rc_telem_page *page;
+};
+
+struct rc_telem *rc_telem_open(const char *path)
+{
+    int fd = open(path ? path : RC_TELEM_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+
+    void *p = mmap(NULL, sizeof(struct rc_telem_page), PROT_READ,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    struct rc_telem_page *page = p;
+    if (page->magic != RC_TELEM_MAGIC ||
+        page->version != RC_TELEM_VERSION ||
+        page->size != sizeof(*page)) {
+        munmap(p, sizeof(*page));
+        return NULL;
+    }
+
+    struct rc_telem *t = malloc(sizeof(*t));
+    if (!t) {
+        munmap(p, sizeof(*page));
+        return NULL;
+    }
+    t->page = page;
+
+    return t;
+}
+
+int rc_telem_read(struct rc_telem *t, struct rc_telem_data *out)
+{
+    for (int i = 0; i < READ_RETRIES; i++) {
+        if (i >= READ_SPINS)
+            sched_yield();
+
+        unsigned s = atomic_load_explicit(&t->page->seq,
+                                          memory_order_acquire);
+        if (s & 1)
+            continue;
+
+        memcpy(out, &t->page->data, sizeof(*out));
+
+        if (!seq_read_retry(&t->page->seq, s))
+            return 0;
+    }
+
+    return -1;
+}
+
+void rc_telem_close(struct rc_telem *t)
+{
+    if (!t)
+        return;
+    munmap(t->page, sizeof(*t->page));
+    free(t);
+}
@@ -8,12 +8,37 @@
  *  - DOES NOT terminate processes
  *  - Uses reversible, rate-limited mitigation
  *  - Uses RC thermal prediction
+ *  - Optionally raises fans (cooling devices, hwmon PWM) before
+ *    capping frequency, and lowers them only after the cap is gone
+ *  - Optionally clamps designated cgroups via cpu.uclamp.max
+ *  - On hybrid parts caps the performance cores only and can steer
+ *    background cgroups onto the efficient cores while mitigating
+ *  - Injects forced idle when the cap alone cannot hold T_CRITICAL
+ *  - Journals every limit change and restores originals on exit,
+ *    on SIGTERM/SIGINT and on the next start after a crash
+ *  - Sampler, model and actuator run as a pipeline of threads joined
+ *    by lock-free rings; the main thread's epoll loop handles signals,
+ *    config changes and the Unix-domain control socket
+ *  - Optional real-time mode (SCHED_FIFO, mlockall, housekeeping CPU)
+ *  - Parameters come from a config file, hot-reloaded on change
+ *  - Publishes its state to /dev/shm under a seqlock (rc_telemetry.h)
+ *    and the thermal headroom left for cooperative clients, who can
+ *    block until there is enough (rc_headroom.h)
+ *  - Records every sample to a binary delta-encoded log (rc_record.h,
+ *    tools/rc_decode) and prints only a periodic summary
+ *  - Keeps min/max/mean history at 1 s, 1 min and 1 h in bounded
+ *    rings, queryable over the control socket
+ *  - --replay runs the same decision path over a recorded trace on a
+ *    virtual clock
+ *  - Attributes CPU heat to processes from incremental /proc scans and
+ *    names the top contributors when mitigation starts
  *
  * Compile:
- *   gcc rc_thermal_scheduler.c -o rc_sched -lm
+ *   make
  *
  * Run:
- *   sudo ./rc_sched
+ *   sudo ./rc_sched [-u /sys/fs/cgroup/batch.slice ...] [--uclamp-only]
+ *   ./rc_sched --query status
  */
 
 #include <stdio.h>
@@ -22,205 +47,808 @@
 #include <math.h>
 #include <time.h>
 #include <string.h>
+#include <getopt.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/inotify.h>
+#include <sys/timerfd.h>
+
+#include "uclamp.h"
+#include "msglog.h"
+#include "steer.h"
+#include "fan.h"
+#include "idle_inject.h"
+#include "journal.h"
+#include "control.h"
+#include "pipeline.h"
+#include "config.h"
+#include "telemetry.h"
+#include "headroom.h"
+#include "recorder.h"
+#include "controller.h"
+#include "replay.h"
+#include "selfstat.h"
+#include "attrib.h"
+#include "history.h"
+
+#define CONFIG_PATH   "/etc/rc_sched.conf"
+#define TRIPS_REFRESH_S 5.0    // trip point re-read interval
+
+/* Model, hysteresis and safety parameters: see config.h */
 
 /* =======================
-   PATHS
+   Event loop
    ======================= */
-#define TEMP_PATH "/sys/class/thermal/thermal_zone0/temp"
-#define FREQ_CUR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq"
-#define FREQ_MAX_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_max_freq"
 
-/* =======================
-   RC MODEL PARAMETERS
-   ======================= */
-#define R_THERMAL   1.0
-#define C_THERMAL   10.0
-#define T_AMBIENT   30.0
-#define DT          1.0
+/*
+ * Sampling runs in the pipeline threads; the main thread's epoll set
+ * only carries housekeeping sources. Handler run time is accounted
+ * per source, lateness is tracked by the pipeline's sampler.
+ */
+enum ev_source {
+    EV_SIGNAL,
+    EV_CONFIG,
+    EV_CONTROL,
+    EV_CLIENT,
+    EV_ATTRIB,
+    EV_TRIPS,
+    EV_LOG,
+    EV_COUNT
+};
+
+struct ev_stats {
+    const char *name;
+    unsigned long long count;
+    unsigned long long run_total_ns, run_max_ns;
+};
+
+static struct ev_stats ev_stats[EV_COUNT] = {
+    [EV_SIGNAL]  = { .name = "signal" },
+    [EV_CONFIG]  = { .name = "config" },
+    [EV_CONTROL] = { .name = "accept" },
+    [EV_CLIENT]  = { .name = "client" },
+    [EV_ATTRIB]  = { .name = "attrib" },
+    [EV_TRIPS]   = { .name = "trips" },
+    [EV_LOG]     = { .name = "log" },
+};
+
+static const char *config_path = CONFIG_PATH;
+static const char *socket_path = CONTROL_SOCKET_PATH;
+static const char *telemetry_path = RC_TELEM_PATH;
+static const char *headroom_path = RC_HEADROOM_PATH;
+static const char *record_path = RECORDER_PATH;
+static double record_mb = RECORDER_DEFAULT_MB;
+static double period_ms = DEFAULT_DT * 1000.0;
+static struct rt_config rt_cfg = { .prio = 0, .cpu = -1 };
+static int uclamp_only = 0;        // leave scaling_max_freq alone
+static int cap_efficient = 0;      // hybrid: cap E-core policies too
+static double summary_s = 1.0;     // console summary interval, 0 = off
+static double attrib_s = 1.0;      // /proc scan interval, 0 = off
+static int running = 1;
+
+static unsigned long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
 
-/* =======================
-   HYSTERESIS LIMITS
-   ======================= */
-#define T_HIGH      75.0
-#define T_LOW       70.0
-#define T_CRITICAL  85.0
+static void ev_account(struct ev_stats *st, unsigned long long run_ns)
+{
+    st->count++;
+    st->run_total_ns += run_ns;
+    if (run_ns > st->run_max_ns) st->run_max_ns = run_ns;
+}
 
-/* =======================
-   POWER MODEL
-   ======================= */
-#define ALPHA       5.0
+/* Clients are edge-triggered both ways: a reply may need several sends */
+static int ev_add(int epfd, int fd, enum ev_source src)
+{
+    struct epoll_event ev = {
+        .events = src == EV_CLIENT ? EPOLLIN | EPOLLOUT | EPOLLET : EPOLLIN,
+        .data.u64 = ((uint64_t)src << 32) | (uint32_t)fd,
+    };
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+}
 
-/* =======================
-   SAFETY PARAMETERS
-   ======================= */
-#define ACTION_COOLDOWN 5   // seconds between mitigation actions
+/* Watch the directory: editors replace config files by rename */
+static int config_watch_open(const char *path)
+{
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (!slash)
+        snprintf(dir, sizeof(dir), ".");
+    else if (slash == dir)
+        dir[1] = '\0';
+    else
+        *slash = '\0';
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    if (inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(fd);
+        return -1;
+    }
 
-/* =======================
-   GLOBAL STATE
-   ======================= */
-static int mitigation_active = 0;
-static time_t last_action_time = 0;
-static int original_max_freq = -1;
+    return fd;
+}
 
-/* =======================
-   Utility functions
-   ======================= */
+/* Drain inotify; returns 1 if the config file itself changed */
+static int config_changed(int fd, const char *path)
+{
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int hit = 0;
+    ssize_t n;
+
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n; ) {
+            struct inotify_event *ie = (struct inotify_event *)p;
+            if (ie->len && strcmp(ie->name, base) == 0)
+                hit = 1;
+            p += sizeof(*ie) + ie->len;
+        }
+    }
 
-double read_temperature()
+    return hit;
+}
+
+static void reload_config(void)
 {
-    FILE *fp = fopen(TEMP_PATH, "r");
-    if (!fp) return -1.0;
+    if (config_reload(config_path, 0) == 0)
+        printf("Configuration reloaded from %s (generation %llu)\n",
+               config_path, (unsigned long long)params_get()->generation);
+}
 
-    int temp_milli;
-    fscanf(fp, "%d", &temp_milli);
-    fclose(fp);
+static void ctl_params(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+    const struct rc_params *p = params_get();
+
+    ctl_printf(r, "source=%s generation=%llu\n", config_path,
+               (unsigned long long)p->generation);
+    ctl_printf(r, "r_thermal=%g c_thermal=%g t_ambient=%g dt=%g\n",
+               p->r_thermal, p->c_thermal, p->t_ambient, p->dt);
+    ctl_printf(r, "t_high=%g t_low=%g t_critical=%g\n",
+               p->t_high, p->t_low, p->t_critical);
+    ctl_printf(r, "trip_auto=%g trip_high_offset=%g "
+               "trip_critical_offset=%g\n",
+               p->trip_auto, p->trip_high_offset, p->trip_critical_offset);
+
+    const struct topology *t = controller_topology();
+    int n = t->n_packages > 0 ? t->n_packages : 1;
+    for (int k = 0; k < n && k < SAMPLE_MAX_PKG; k++) {
+        struct trips tr;
+        struct rc_params e;
+        controller_trips(k, &tr);
+        if (!trips_thresholds(p, &tr, &e))
+            continue;
+        ctl_printf(r, "controller %d: passive=%g critical=%g -> "
+                   "t_high=%g t_low=%g t_critical=%g\n", k, tr.passive,
+                   tr.critical, e.t_high, e.t_low, e.t_critical);
+    }
+    ctl_printf(r, "alpha=%g action_cooldown=%g cap_factor=%g\n",
+               p->alpha, p->action_cooldown, p->cap_factor);
+    ctl_printf(r, "fan_r_factor=%g fan_step=%g\n",
+               p->fan_r_factor, p->fan_step);
+    ctl_printf(r, "sensor_stale_reads=%g sensor_stuck_time=%g "
+               "sensor_stuck_delta=%g\n", p->sensor_stale_reads,
+               p->sensor_stuck_time, p->sensor_stuck_delta);
+    ctl_printf(r, "ramp_drift=%g ramp_threshold=%g ramp_horizon=%g "
+               "ramp_cap_factor=%g\n",
+               p->ramp_drift, p->ramp_threshold, p->ramp_horizon,
+               p->ramp_cap_factor);
+}
+
+/* Returns 0 to stop the loop */
+static int handle_signal(int fd)
+{
+    struct signalfd_siginfo si;
+
+    while (read(fd, &si, sizeof(si)) == sizeof(si)) {
+        if (si.ssi_signo == SIGHUP) {
+            reload_config();
+            continue;
+        }
+        printf("\nSignal %u received — restoring limits\n", si.ssi_signo);
+        return 0;
+    }
 
-    return temp_milli / 1000.0;
+    return 1;
 }
 
-double read_frequency()
+/* Distinct values of `ids` over the online cpus of package k */
+static int count_ids(const struct topology *t, const int16_t *ids, int k)
 {
-    FILE *fp = fopen(FREQ_CUR_PATH, "r");
-    if (!fp) return -1.0;
+    int n = 0;
 
-    int freq_khz;
-    fscanf(fp, "%d", &freq_khz);
-    fclose(fp);
+    for (int cpu = 0; cpu < t->n_cpus; cpu++) {
+        if (t->pkg[cpu] != k)
+            continue;
+        int seen = 0;
+        for (int c = 0; c < cpu && !seen; c++)
+            seen = t->pkg[c] == k && ids[c] == ids[cpu];
+        n += !seen;
+    }
+    return n;
+}
 
-    return freq_khz / 1e6;
+/* Online cpus of package k of core type `type` */
+static int count_type(const struct topology *t, int k, int type)
+{
+    int n = 0;
+
+    for (int cpu = 0; cpu < t->n_cpus; cpu++)
+        n += t->pkg[cpu] == k && t->core_type[cpu] == type;
+    return n;
 }
 
-int read_max_frequency()
+static void describe_package(const struct topology *t, int k,
+                             char *buf, size_t len)
 {
-    FILE *fp = fopen(FREQ_MAX_PATH, "r");
-    if (!fp) return -1;
+    int z = t->pkg_zone[k];
+    int off = snprintf(buf, len,
+                       "package %d: %d cpus, %d dies, %d clusters, "
+                       "%d cores, %d policies, ",
+                       t->package_id[k], t->pkg_cpus[k],
+                       count_ids(t, t->die, k), count_ids(t, t->cluster, k),
+                       count_ids(t, t->core, k), t->pkg_policies[k]);
+
+    if (t->hybrid) {
+        int cpus[1];
+        int perf = count_type(t, k, TOPO_CORE_PERF);
+        int capped = cap_efficient ||
+                     topology_policies_of(t, k, TOPO_CORE_PERF, cpus, 1) == 0;
+        off += snprintf(buf + off, len - off,
+                        "%d perf + %d eff cpus by %s (capping %s), ",
+                        perf, count_type(t, k, TOPO_CORE_EFF),
+                        t->hybrid_by, capped ? "all" : "perf only");
+    }
 
-    int freq;
-    fscanf(fp, "%d", &freq);
-    fclose(fp);
+    if (z >= 0)
+        off += snprintf(buf + off, len - off, "thermal_zone%d (%s)",
+                        z, t->zone_type[z]);
+    else
+        off += snprintf(buf + off, len - off, "thermal_zone0 (fallback)");
 
-    return freq;
+    if (t->pkg_rapl[k] >= 0)
+        snprintf(buf + off, len - off, ", intel-rapl:%d", t->pkg_rapl[k]);
 }
 
-void write_max_frequency(int freq)
+static void ctl_topology(const char *args, struct ctl_reply *r)
 {
-    FILE *fp = fopen(FREQ_MAX_PATH, "w");
-    if (!fp) return;
+    (void)args;
+    const struct topology *t = controller_topology();
+    char line[320];
 
-    fprintf(fp, "%d", freq);
-    fclose(fp);
+    if (t->n_packages == 0) {
+        ctl_printf(r, "no topology: one controller on thermal_zone0, cpu0\n");
+        return;
+    }
+    for (int k = 0; k < t->n_packages && k < SAMPLE_MAX_PKG; k++) {
+        describe_package(t, k, line, sizeof(line));
+        ctl_printf(r, "%s\n", line);
+    }
 }
 
-/* Placeholder CPU utilization (safe default) */
-double estimate_utilization()
+static void ctl_status(const char *args, struct ctl_reply *r)
 {
-    return 0.7;
+    (void)args;
+
+    struct rc_telem_data d;
+    controller_snapshot(&d);
+
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    double age = ((int64_t)wall.tv_sec * 1000000000LL + wall.tv_nsec -
+                  d.t_wall_ns) / 1e9;
+
+    if (d.valid)
+        ctl_printf(r, "T=%.2f T_pred=%.2f freq_ghz=%.3f power_w=%.2f "
+                   "age_s=%.3f\n",
+                   d.zones[0].temp_c, d.zones[0].pred_c, d.freq_ghz,
+                   d.power_w, age);
+    else
+        ctl_printf(r, "no valid sample\n");
+
+    ctl_printf(r, "mitigation=%u cap_khz=%d uclamp_cgroups=%d "
+               "uclamp_pct=%.0f idle_pct=%d\n",
+               d.mitigation_level, d.cap_khz, uclamp_count(),
+               d.uclamp_pct, d.idle_pct);
+    ctl_printf(r, "fans=%d fan_pct=%.0f\n", fan_count(),
+               fan_level() * 100.0);
+
+    struct health_stats h;
+    double sensor_age;
+    for (int k = 0; controller_health(k, &h, &sensor_age) == 0; k++)
+        ctl_printf(r, "sensor %d: reads=%llu failures=%llu spikes=%llu "
+                   "stuck=%d/%llu held=%d good_age_s=%.3f "
+                   "lat_us=%.0f/%.0f/%.0f\n", k,
+                   (unsigned long long)h.reads,
+                   (unsigned long long)h.failures,
+                   (unsigned long long)h.spikes, h.stuck,
+                   (unsigned long long)h.stuck_events, h.held, sensor_age,
+                   h.lat_last_us, h.lat_mean_us, h.lat_max_us);
+    selfstat_report(r);
 }
 
-/* =======================
-   RC Thermal Model
-   ======================= */
-double predict_temperature(
-    double T_curr,
-    double power,
-    double Tamb,
-    double R,
-    double C,
-    double dt
-) {
-    return T_curr + (dt / C) * (power - (T_curr - Tamb) / R);
+static void ctl_events(const char *args, struct ctl_reply *r)
+{
+    (void)args;
+
+    ctl_printf(r, "%-8s %10s %12s %12s\n", "source", "count",
+               "run_avg_us", "run_max_us");
+    for (int i = 0; i < EV_COUNT; i++) {
+        const struct ev_stats *st = &ev_stats[i];
+        double n = st->count ? (double)st->count : 1.0;
+        ctl_printf(r, "%-8s %10llu %12.1f %12.1f\n",
+                   st->name, st->count,
+                   st->run_total_ns / n / 1e3, st->run_max_ns / 1e3);
+    }
 }
 
-/* =======================
-   Safe mitigation logic
-   ======================= */
-int can_act()
+static int interval_timer_open(double interval_s)
 {
-    time_t now = time(NULL);
-    return difftime(now, last_action_time) >= ACTION_COOLDOWN;
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    long long ns = (long long)(interval_s * 1e9);
+    struct itimerspec its = {
+        .it_value    = { ns / 1000000000LL, ns % 1000000000LL },
+        .it_interval = { ns / 1000000000LL, ns % 1000000000LL },
+    };
+    timerfd_settime(fd, 0, &its, NULL);
+    return fd;
 }
 
-void enable_mitigation()
+static int attrib_timer_open(double interval_s)
 {
-    if (mitigation_active || !can_act())
-        return;
+    if (interval_s <= 0.0 || attrib_open(NULL) < 0)
+        return -1;
+    return interval_timer_open(interval_s);
+}
 
-    original_max_freq = read_max_frequency();
-    if (original_max_freq <= 0)
-        return;
+/*
+ * Trip points can be changed at run time (by thermald, firmware or an
+ * admin) and sysfs sends no inotify events for them, so they are
+ * polled.
+ */
+static void handle_trips(int fd)
+{
+    uint64_t exp;
+
+    if (read(fd, &exp, sizeof(exp)) == sizeof(exp))
+        controller_refresh_trips();
+}
 
-    int reduced_freq = (int)(original_max_freq * 0.7);
+/* Scan /proc; name the hottest processes when mitigation starts */
+static void handle_attrib(int fd)
+{
+    static uint32_t prev_level;
+    uint64_t exp;
 
-    write_max_frequency(reduced_freq);
-    mitigation_active = 1;
-    last_action_time = time(NULL);
+    if (read(fd, &exp, sizeof(exp)) != sizeof(exp))
+        return;
 
-    printf("⚠️  Mitigation ENABLED: max freq capped\n");
+    struct rc_telem_data d;
+    controller_snapshot(&d);
+    /* without a valid sample CPU time is still ranked, at 0 W */
+    attrib_scan(d.valid ? d.freq_ghz : 0.0, params_get()->alpha);
+
+    if (d.mitigation_level > prev_level && prev_level == 0) {
+        const struct attrib_pass *a = attrib_last();
+        printf("Mitigation started; top heat sources:");
+        for (unsigned i = 0; i < a->n_top && i < 3; i++)
+            printf(" %s[%d] %.2fW", a->top[i].comm, a->top[i].pid,
+                   a->top[i].watts);
+        printf("\n");
+    }
+    prev_level = d.mitigation_level;
 }
 
-void disable_mitigation()
+static int event_loop(void)
 {
-    if (!mitigation_active || !can_act())
-        return;
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGHUP);
+
+    int epfd  = epoll_create1(EPOLL_CLOEXEC);
+    int sfd   = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    int ifd   = config_watch_open(config_path);
+    int lfd   = control_listen(socket_path);
+    int afd   = attrib_timer_open(attrib_s);
+    int tfd   = interval_timer_open(TRIPS_REFRESH_S);
+    int mfd   = msglog_open();
+
+    if (epfd < 0 || sfd < 0) {
+        perror("event loop setup");
+        return -1;
+    }
 
-    if (original_max_freq > 0)
-        write_max_frequency(original_max_freq);
+    ev_add(epfd, sfd, EV_SIGNAL);
+    if (ifd >= 0)
+        ev_add(epfd, ifd, EV_CONFIG);
+    if (lfd >= 0)
+        ev_add(epfd, lfd, EV_CONTROL);
+    if (afd >= 0)
+        ev_add(epfd, afd, EV_ATTRIB);
+    if (tfd >= 0)
+        ev_add(epfd, tfd, EV_TRIPS);
+    if (mfd >= 0 && ev_add(epfd, mfd, EV_LOG) < 0)
+        msglog_close();
+
+    if (pipeline_start(&controller_ops, (uint64_t)(period_ms * 1e6), &rt_cfg) < 0) {
+        perror("pipeline");
+        return -1;
+    }
 
-    mitigation_active = 0;
-    last_action_time = time(NULL);
+    while (running) {
+        struct epoll_event events[16];
+        int n = epoll_wait(epfd, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            break;
+        }
 
-    printf("✅ Mitigation DISABLED: freq restored\n");
+        for (int i = 0; i < n && running; i++) {
+            enum ev_source src = (enum ev_source)(events[i].data.u64 >> 32);
+            int fd = (int)(uint32_t)events[i].data.u64;
+            unsigned long long t0 = now_ns();
+
+            switch (src) {
+            case EV_SIGNAL:
+                running = handle_signal(fd);
+                break;
+            case EV_CONFIG:
+                if (config_changed(fd, config_path))
+                    reload_config();
+                break;
+            case EV_CONTROL: {
+                int cfd;
+                while ((cfd = control_accept(fd)) >= 0)
+                    if (ev_add(epfd, cfd, EV_CLIENT) < 0)
+                        close(cfd);
+                break;
+            }
+            case EV_CLIENT:
+                if (control_serve(fd) == 0)
+                    close(fd);      // also leaves the epoll set
+                break;
+            case EV_ATTRIB:
+                handle_attrib(fd);
+                break;
+            case EV_TRIPS:
+                handle_trips(fd);
+                break;
+            case EV_LOG:
+                msglog_drain();
+                break;
+            default:
+                break;
+            }
+
+            ev_account(&ev_stats[src], now_ns() - t0);
+        }
+    }
+
+    pipeline_stop();
+    msglog_close();
+
+    control_close(lfd, socket_path);
+    if (ifd >= 0) close(ifd);
+    if (afd >= 0) close(afd);
+    if (tfd >= 0) close(tfd);
+    attrib_close();
+    close(sfd);
+    close(epfd);
+
+    return 0;
 }
 
 /* =======================
-   Main control loop
+   Command line
    ======================= */
-int main()
+static void usage(const char *prog)
 {
-    printf("RC-Based Thermal-Aware Scheduler Controller (SAFE MODE)\n");
-    printf("------------------------------------------------------\n");
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -u, --uclamp-cgroup DIR  clamp cpu.uclamp.max of cgroup DIR\n"
+            "                           (repeatable)\n"
+            "  -U, --uclamp-only        mitigate with uclamp only, do not\n"
+            "                           cap scaling_max_freq\n"
+            "  -E, --cap-efficient      on hybrid parts cap the efficient\n"
+            "                           cores' policies too\n"
+            "  -F, --fan PATH           raise this cooling device directory\n"
+            "                           or hwmon pwmN before capping;\n"
+            "                           \"auto\" takes every fan cooling\n"
+            "                           device (repeatable)\n"
+            "  -B, --background-cgroup DIR\n"
+            "                           move cgroup DIR onto the efficient\n"
+            "                           cores while mitigating (repeatable)\n"
+            "  -p, --period-ms MS       sampling period (default %.0f)\n"
+            "  -r, --rt-prio PRIO       run the pipeline SCHED_FIFO at PRIO,\n"
+            "                           with mlockall and prefaulted stacks\n"
+            "  -C, --rt-cpu CPU         keep all daemon threads on CPU\n"
+            "  -c, --config FILE        configuration file (default %s)\n"
+            "  -s, --socket PATH        control socket (default %s)\n"
+            "  -t, --telemetry PATH     shared-memory telemetry file\n"
+            "                           (default %s, \"\" disables)\n"
+            "  -H, --headroom PATH      shared-memory headroom page for\n"
+            "                           cooperative clients\n"
+            "                           (default %s, \"\" disables)\n"
+            "  -R, --record PATH        binary sample log\n"
+            "                           (default %s, \"\" disables)\n"
+            "  -M, --record-mb MB       sample log size (default %d)\n"
+            "  -S, --summary SEC        console summary interval\n"
+            "                           (default %.0f, 0 disables)\n"
+            "  -A, --attrib SEC         per-process heat attribution scan\n"
+            "                           interval (default %.0f, 0 disables)\n"
+            "  -P, --replay TRACE       run the controller over a recorded\n"
+            "                           trace (sample log or text) and exit\n"
+            "  -q, --query CMD          send CMD to a running daemon\n"
+            "  -h, --help               show this help\n",
+            prog, DEFAULT_DT * 1000.0, CONFIG_PATH, CONTROL_SOCKET_PATH,
+            RC_TELEM_PATH, RC_HEADROOM_PATH, RECORDER_PATH,
+            RECORDER_DEFAULT_MB, summary_s,
+            attrib_s);
+}
 
-    while (1) {
-        double T_curr = read_temperature();
-        double freq   = read_frequency();
-        double util   = estimate_utilization();
+static const char *query_cmd = NULL;
+static const char *replay_path = NULL;
 
-        if (T_curr < 0 || freq < 0) {
-            printf("Sensor read failed — entering safe mode\n");
-            disable_mitigation();
-            sleep((int)DT);
-            continue;
+static int parse_args(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "uclamp-cgroup", required_argument, NULL, 'u' },
+        { "uclamp-only",   no_argument,       NULL, 'U' },
+        { "cap-efficient", no_argument,       NULL, 'E' },
+        { "background-cgroup", required_argument, NULL, 'B' },
+        { "fan",           required_argument, NULL, 'F' },
+        { "period-ms",     required_argument, NULL, 'p' },
+        { "rt-prio",       required_argument, NULL, 'r' },
+        { "rt-cpu",        required_argument, NULL, 'C' },
+        { "config",        required_argument, NULL, 'c' },
+        { "socket",        required_argument, NULL, 's' },
+        { "telemetry",     required_argument, NULL, 't' },
+        { "headroom",      required_argument, NULL, 'H' },
+        { "record",        required_argument, NULL, 'R' },
+        { "record-mb",     required_argument, NULL, 'M' },
+        { "summary",       required_argument, NULL, 'S' },
+        { "attrib",        required_argument, NULL, 'A' },
+        { "replay",        required_argument, NULL, 'P' },
+        { "query",         required_argument, NULL, 'q' },
+        { "help",          no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "u:UEB:F:p:r:C:c:s:t:H:R:M:S:A:P:q:h", opts, NULL)) != -1) {
+        switch (c) {
+        case 'u':
+            if (uclamp_add_cgroup(optarg) < 0)
+                return -1;
+            break;
+        case 'U':
+            uclamp_only = 1;
+            break;
+        case 'E':
+            cap_efficient = 1;
+            break;
+        case 'B':
+            if (steer_add_cgroup(optarg) < 0)
+                return -1;
+            break;
+        case 'F':
+            if (strcmp(optarg, "auto") == 0) {
+                if (fan_discover() == 0) {
+                    fprintf(stderr, "no fan cooling devices found\n");
+                    return -1;
+                }
+            }
+            else if (fan_add(optarg) < 0) {
+                return -1;
+            }
+            break;
+        case 'p':
+            period_ms = atof(optarg);
+            if (period_ms < 0.1) {
+                fprintf(stderr, "period must be at least 0.1 ms\n");
+                return -1;
+            }
+            break;
+        case 'r':
+            rt_cfg.prio = atoi(optarg);
+            if (rt_cfg.prio < 1 || rt_cfg.prio > 99) {
+                fprintf(stderr, "rt priority must be 1..99\n");
+                return -1;
+            }
+            break;
+        case 'C':
+            rt_cfg.cpu = atoi(optarg);
+            break;
+        case 'c':
+            config_path = optarg;
+            break;
+        case 's':
+            socket_path = optarg;
+            break;
+        case 't':
+            telemetry_path = optarg;
+            break;
+        case 'H':
+            headroom_path = optarg;
+            break;
+        case 'R':
+            record_path = optarg;
+            break;
+        case 'M':
+            record_mb = atof(optarg);
+            if (record_mb <= 0) {
+                fprintf(stderr, "record size must be positive\n");
+                return -1;
+            }
+            break;
+        case 'S':
+            summary_s = atof(optarg);
+            break;
+        case 'A':
+            attrib_s = atof(optarg);
+            break;
+        case 'P':
+            replay_path = optarg;
+            break;
+        case 'q':
+            query_cmd = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
         }
+    }
 
-        double power = ALPHA * util * freq;
-
-        double T_pred = predict_temperature(
-            T_curr,
-            power,
-            T_AMBIENT,
-            R_THERMAL,
-            C_THERMAL,
-            DT
-        );
+    if (replay_path && (uclamp_count() > 0 || steer_count() > 0 ||
+                        fan_count() > 0)) {
+        fprintf(stderr, "--replay does not drive real cgroups or fans\n");
+        return -1;
+    }
 
-        printf("T=%.2f°C | T_pred=%.2f°C | f=%.2f GHz | P=%.2f W\n",
-               T_curr, T_pred, freq, power);
+    if (uclamp_only && uclamp_count() == 0) {
+        fprintf(stderr, "--uclamp-only needs at least one --uclamp-cgroup\n");
+        return -1;
+    }
 
-        /* Hysteresis-based control */
-        if (T_pred > T_HIGH) {
-            enable_mitigation();
-        }
-        else if (T_pred < T_LOW) {
-            disable_mitigation();
-        }
+    return 0;
+}
 
-        if (T_pred > T_CRITICAL) {
-            printf("CRITICAL predicted temperature — strong throttling advised\n");
-        }
+/* =======================
+   Main
+   ======================= */
 
-        sleep((int)DT);
+/* Nothing on the host is touched: no journal, sysfs or telemetry */
+static int run_replay(void)
+{
+    if (config_reload(config_path, 1) < 0)
+        return -1;
+
+    struct replay_trace *tr = replay_load(replay_path);
+    if (!tr) {
+        fprintf(stderr, "replay: %s: %s\n", replay_path,
+                errno == EINVAL ? "unreadable sample log" : strerror(errno));
+        return -1;
     }
 
+    controller_configure(0, 0);
+
+    struct replay_result res;
+    unsigned long long t0 = now_ns();
+    replay_run(tr, &controller_ops, params_get(), &res);
+    replay_print(&res, (now_ns() - t0) / 1e9);
+
+    replay_free(tr);
+    params_shutdown();
     return 0;
 }
+int main(int argc, char **argv)
+{
+    if (parse_args(argc, argv) < 0)
+        return 1;
+
+    if (query_cmd)
+        return control_query(socket_path, query_cmd) < 0;
+
+    if (replay_path)
+        return run_replay() < 0;
+
+    /*
+     * Termination arrives through the signalfd in the event loop, so
+     * limits are restored from ordinary context before exit.
+     */
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGHUP);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+
+    /* Undo whatever a previous instance left behind before anything else */
+    if (journal_open(JOURNAL_PATH) > 0)
+        printf("Restored %d limit(s) left by a previous run\n",
+               journal_restore_all());
+
+    printf("RC-Based Thermal-Aware Scheduler Controller (SAFE MODE)\n");
+    printf("------------------------------------------------------\n");
 
+    /* A broken file at startup is fatal; later ones keep the old set */
+    if (config_reload(config_path, 1) < 0)
+        return 1;
+
+    controller_configure(uclamp_only, summary_s);
+    controller_cap_efficient(cap_efficient);
+    if (controller_bind_host(NULL) > 0) {
+        const struct topology *t = controller_topology();
+        char line[320];
+        for (int k = 0; k < t->n_packages && k < SAMPLE_MAX_PKG; k++) {
+            describe_package(t, k, line, sizeof(line));
+            printf("Controlling %s\n", line);
+        }
+    }
+    if (idle_inject_init() == 0)
+        printf("No idle-cpuN or intel_powerclamp cooling device: "
+               "idle injection unavailable\n");
+
+    if (*telemetry_path)
+        telemetry_open(telemetry_path);
+    if (*headroom_path)
+        headroom_open(headroom_path);
+
+    if (*record_path)
+        recorder_open(record_path, (size_t)(record_mb * 1024 * 1024));
+
+    /*
+     * Lock after the actuators have probed sysfs and before any thread
+     * starts; the main thread joins the housekeeping CPU too.
+     */
+    if (rt_cfg.prio > 0) {
+        rt_lock_memory();
+        rt_prefault_stack();
+    }
+    if (rt_cfg.cpu >= 0)
+        rt_setup_thread(0, rt_cfg.cpu);
+
+    control_register("status", "last sample and actuator state", ctl_status);
+    control_register("params", "active parameter set", ctl_params);
+    control_register("topology", "packages and what each controller drives",
+                     ctl_topology);
+    control_register("events", "per event source latency", ctl_events);
+    control_register("pipeline", "per stage latency and queue depth",
+                     pipeline_report);
+    control_register("heat", "top CPU heat contributors by process",
+                     attrib_report);
+    control_register("jitter", "sampler wakeup lateness histogram",
+                     pipeline_jitter);
+    control_register("history", "[SERIES [raw|1s|1m|1h [N]]] recent values",
+                     history_report);
+
+    int rc = event_loop();
+
+    idle_inject_stop();
+    journal_restore_all();
+    params_shutdown();
+    telemetry_close();
+    headroom_close();
+    recorder_close();
+
+    return rc < 0;
+}
@@ -0,0 +1,461 @@
+/*
+ * Hysteresis and actuator policy for one controller instance
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "rcthermal.h"
+
+static void note(struct rct_controller *c, const char *fmt, ...)
+{
+    char msg[192];
+    va_list ap;
+
+    if (!c->note)
+        return;
+
+    va_start(ap, fmt);
+    vsnprintf(msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    c->note(c->note_arg, c->plat.ops->now(c->plat.ctx), msg);
+}
+
+/* =======================
+   Platform shorthands
+   ======================= */
+static double now(struct rct_controller *c)
+{
+    return c->plat.ops->now(c->plat.ctx);
+}
+
+static int read_max(struct rct_controller *c)
+{
+    return c->plat.ops->read_max_frequency(c->plat.ctx);
+}
+
+static void write_max(struct rct_controller *c, int khz)
+{
+    c->plat.ops->write_max_frequency(c->plat.ctx, khz);
+}
+
+static void restore_max(struct rct_controller *c)
+{
+    if (c->plat.ops->restore_max_frequency(c->plat.ctx) < 0 &&
+        c->original_max_freq > 0)
+        write_max(c, c->original_max_freq);
+}
+
+static void clamp(struct rct_controller *c, double overshoot)
+{
+    if (c->act.ops && c->act.ops->clamp)
+        c->act.ops->clamp(c->act.ctx, overshoot);
+}
+
+static void unclamp(struct rct_controller *c)
+{
+    if (c->act.ops && c->act.ops->unclamp)
+        c->act.ops->unclamp(c->act.ctx);
+}
+
+static void idle_set(struct rct_controller *c, double frac)
+{
+    if (c->act.ops && c->act.ops->idle_set)
+        c->act.ops->idle_set(c->act.ctx, frac);
+}
+
+static int has_cooling(const struct rct_controller *c)
+{
+    return c->act.ops && c->act.ops->cool_set;
+}
+
+static void cool_set(struct rct_controller *c, double level)
+{
+    c->cooling = level;
+    if (has_cooling(c))
+        c->act.ops->cool_set(c->act.ctx, level);
+}
+
+/* R of the sample's plant, with the fans it was taken under */
+static double r_of(const struct rc_params *p, const struct sample_rec *r)
+{
+    return effective_resistance(p->r_thermal, p->fan_r_factor, r->cooling);
+}
+
+int rct_idle_pct(const struct rct_controller *c)
+{
+    if (c->act.ops && c->act.ops->idle_pct)
+        return c->act.ops->idle_pct(c->act.ctx);
+    return 0;
+}
+
+/* =======================
+   Safe mitigation logic
+   ======================= */
+static int can_act(struct rct_controller *c, const struct rc_params *p)
+{
+    return now(c) - c->last_action_time >= p->action_cooldown;
+}
+
+static void enable_mitigation(struct rct_controller *c,
+                              const struct rc_params *p, double T_pred)
+{
+    /* clamps follow the overshoot while mitigation is on */
+    if (c->mitigation_active) {
+        clamp(c, T_pred - p->t_high);
+        return;
+    }
+
+    /* Tightening an early cap is not held back by the cooldown */
+    if (!can_act(c, p) && !c->precapped)
+        return;
+
+    if (!c->clamp_only) {
+        if (!c->precapped)
+            c->original_max_freq = read_max(c);
+        if (c->original_max_freq <= 0)
+            return;
+
+        int reduced_freq = (int)(c->original_max_freq * p->cap_factor);
+
+        write_max(c, reduced_freq);
+        c->applied_max_freq = reduced_freq;
+    }
+
+    clamp(c, T_pred - p->t_high);
+    c->mitigation_active = 1;
+    c->precapped = 0;
+    c->last_action_time = now(c);
+
+    note(c, "⚠️  Mitigation ENABLED: %s",
+         c->clamp_only ? "cgroups clamped" : "max freq capped");
+}
+
+static void disable_mitigation(struct rct_controller *c,
+                               const struct rc_params *p)
+{
+    if (!c->mitigation_active || !can_act(c, p))
+        return;
+
+    if (!c->clamp_only)
+        restore_max(c);
+
+    unclamp(c);
+    idle_set(c, 0.0);
+    c->applied_max_freq = -1;
+    c->mitigation_active = 0;
+    c->last_action_time = now(c);
+
+    note(c, "✅ Mitigation DISABLED: freq restored");
+}
+
+/* =======================
+   Fans
+   ======================= */
+
+/*
+ * Raise the fans a step while the prediction is over T_HIGH. Returns 1
+ * while that is still the answer (a step was taken, or the last one
+ * has not had the cooldown to show), 0 once the fans are at full or
+ * the critical band is reached and the frequency has to be capped.
+ */
+static int escalate_cooling(struct rct_controller *c,
+                            const struct rc_params *p, double T_pred)
+{
+    if (!has_cooling(c) || c->mitigation_active)
+        return 0;
+
+    if (T_pred > p->t_critical) {
+        if (c->cooling < 1.0) {
+            cool_set(c, 1.0);
+            note(c, "🌀 Fans to full: critical prediction");
+        }
+        return 0;
+    }
+    if (c->cooling >= 1.0)
+        return 0;
+    if (!can_act(c, p))
+        return 1;
+
+    double level = c->cooling + p->fan_step;
+    cool_set(c, level < 1.0 ? level : 1.0);
+    c->last_action_time = now(c);
+
+    note(c, "🌀 Fans raised to %.0f%%", c->cooling * 100.0);
+    return 1;
+}
+
+/* Lower the fans a step once the cap is gone and the zone is cool */
+static void relax_cooling(struct rct_controller *c, const struct rc_params *p)
+{
+    if (c->cooling <= 0.0 || c->mitigation_active || c->precapped ||
+        !can_act(c, p))
+        return;
+
+    double level = c->cooling - p->fan_step;
+    cool_set(c, level > 1e-9 ? level : 0.0);
+    c->last_action_time = now(c);
+
+    if (c->cooling > 0.0)
+        note(c, "🌀 Fans lowered to %.0f%%", c->cooling * 100.0);
+    else
+        note(c, "🌀 Fans restored");
+}
+
+/* =======================
+   Ramp pre-throttling
+   ======================= */
+
+/* Power the current load would draw without our cap */
+static double uncapped_power(const struct rct_controller *c,
+                             const struct sample_rec *r)
+{
+    if (c->applied_max_freq > 0 && c->original_max_freq > 0)
+        return r->power * c->original_max_freq / c->applied_max_freq;
+    return r->power;
+}
+
+static void release_precap(struct rct_controller *c)
+{
+    if (!c->precapped)
+        return;
+
+    restore_max(c);
+    c->applied_max_freq = -1;
+    c->precapped = 0;
+    c->last_action_time = now(c);
+
+    note(c, "Early cap released");
+}
+
+/*
+ * A rising load is capped lightly before the temperature gets near
+ * T_HIGH if the model, run ramp_horizon seconds ahead at the power the
+ * ramp has reached, says it would cross it. The cap goes once the
+ * uncapped load projects below T_LOW, or becomes the full cap when
+ * the prediction crosses T_HIGH anyway.
+ */
+static void pre_throttle(struct rct_controller *c, const struct rc_params *p,
+                         const struct sample_rec *r, int ramping)
+{
+    if (c->clamp_only || c->mitigation_active || !can_act(c, p))
+        return;
+
+    if (c->precapped) {
+        double T_h = project_temperature(r->T_curr, uncapped_power(c, r),
+                                         p->t_ambient, r_of(p, r),
+                                         p->c_thermal, p->ramp_horizon);
+        if (T_h < p->t_low)
+            release_precap(c);
+        return;
+    }
+
+    if (!ramping || p->ramp_cap_factor >= 1.0)
+        return;
+
+    double level = ramp_level(&c->ramp);
+    double T_h = project_temperature(r->T_curr, level, p->t_ambient,
+                                     r_of(p, r), p->c_thermal,
+                                     p->ramp_horizon);
+    if (T_h <= p->t_high)
+        return;
+
+    /* airflow first, as for T_HIGH itself */
+    if (escalate_cooling(c, p, r->T_pred))
+        return;
+
+    c->original_max_freq = read_max(c);
+    if (c->original_max_freq <= 0)
+        return;
+
+    c->applied_max_freq = (int)(c->original_max_freq * p->ramp_cap_factor);
+    write_max(c, c->applied_max_freq);
+    c->precapped = 1;
+    c->last_action_time = now(c);
+
+    note(c, "📈 Ramp to %.1f W (%+.2f W/s): %.1f°C projected in %.0f s — "
+         "early cap", level, ramp_slope(&c->ramp), T_h, p->ramp_horizon);
+}
+
+/* =======================
+   Controller API
+   ======================= */
+void rct_init(struct rct_controller *c, const struct platform *plat,
+              const struct rct_actuators *act)
+{
+    memset(c, 0, sizeof(*c));
+    c->plat = *plat;
+    if (act)
+        c->act = *act;
+    rct_reset(c);
+}
+
+void rct_reset(struct rct_controller *c)
+{
+    c->mitigation_active = 0;
+    c->precapped = 0;
+    c->cooling = 0.0;
+    c->was_valid = 1;
+    c->last_action_time = -1e9;
+    c->original_max_freq = -1;
+    c->applied_max_freq = -1;
+    ramp_reset(&c->ramp);
+    health_reset(&c->health);
+}
+
+void rct_sample(struct rct_controller *c, const struct rc_params *p,
+                struct sample_rec *r)
+{
+    const struct platform_ops *ops = c->plat.ops;
+    const struct health_limits lim = {
+        .stale_reads = (unsigned)p->sensor_stale_reads,
+        .stuck_s = p->sensor_stuck_time,
+        .stuck_delta = p->sensor_stuck_delta,
+    };
+    struct timespec t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    double raw = ops->read_temperature(c->plat.ctx);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    r->freq   = ops->read_frequency(c->plat.ctx);
+    r->util   = ops->read_utilization(c->plat.ctx);
+    r->cooling = c->act.ops && c->act.ops->cool_level ?
+                     c->act.ops->cool_level(c->act.ctx) : 0.0;
+
+    /* Where the model says this load settles, for the stuck check */
+    double expect = p->t_ambient + r_of(p, r) * p->alpha * r->util *
+                                   (r->freq > 0 ? r->freq : 0.0);
+
+    r->T_curr = health_filter(&c->health, &lim, now(c), raw, expect,
+                              (t1.tv_sec - t0.tv_sec) +
+                              (t1.tv_nsec - t0.tv_nsec) / 1e9);
+    r->valid  = r->T_curr >= 0 && r->freq >= 0;
+}
+
+void rct_model(const struct rc_params *p, struct sample_rec *r)
+{
+    if (!r->valid)
+        return;
+
+    r->power = p->alpha * r->util * r->freq;
+
+    r->T_pred = predict_temperature(
+        r->T_curr,
+        r->power,
+        p->t_ambient,
+        r_of(p, r),
+        p->c_thermal,
+        p->dt
+    );
+}
+
+void rct_actuate(struct rct_controller *c, const struct rc_params *p,
+                 const struct sample_rec *r)
+{
+    /* Safe mode lifts our limits; fans are left up, which is safe */
+    if (!r->valid) {
+        if (c->was_valid)
+            note(c, "Sensor read failed — entering safe mode");
+        disable_mitigation(c, p);
+        release_precap(c);
+        c->was_valid = 0;
+        return;
+    }
+
+    double T_pred = r->T_pred;
+
+    if (!c->was_valid)
+        note(c, "Sensor readings recovered");
+    c->was_valid = 1;
+
+    int ramping = ramp_update(&c->ramp, now(c), uncapped_power(c, r),
+                              p->ramp_drift, p->ramp_threshold);
+    pre_throttle(c, p, r, ramping);
+
+    /*
+     * Hysteresis-based control: fans, then the cap on the way up; the
+     * cap, then fans on the way down
+     */
+    if (T_pred > p->t_high) {
+        if (!escalate_cooling(c, p, T_pred))
+            enable_mitigation(c, p, T_pred);
+    }
+    else if (T_pred < p->t_low) {
+        if (c->mitigation_active)
+            disable_mitigation(c, p);
+        else
+            relax_cooling(c, p);
+    }
+
+    /*
+     * Critical band with the cap already in place: inject idle,
+     * sized by the model, until the prediction drops below T_HIGH.
+     */
+    int idle = rct_idle_pct(c);
+    if (c->mitigation_active &&
+        (T_pred > p->t_critical || (idle > 0 && T_pred > p->t_high))) {
+        double frac = idle_fraction_for_target(
+            r->T_curr, r->power, p->t_high,
+            p->t_ambient, r_of(p, r), p->c_thermal, p->dt);
+        idle_set(c, frac);
+        if (rct_idle_pct(c) != idle)
+            note(c, "CRITICAL predicted temperature — injecting %d%% idle",
+                 rct_idle_pct(c));
+    }
+    else if (idle > 0) {
+        idle_set(c, 0.0);
+        note(c, "Idle injection stopped");
+    }
+}
+
+int rct_level(const struct rct_controller *c)
+{
+    if (!c->mitigation_active)
+        return c->precapped ? RCT_LEVEL_CAPPED : RCT_LEVEL_NONE;
+    return rct_idle_pct(c) > 0 ? RCT_LEVEL_IDLE : RCT_LEVEL_CAPPED;
+}
+
+/* =======================
+   Controller groups
+   ======================= */
+_Static_assert(sizeof(struct rct_slot) % RCT_CACHE_LINE == 0, "slot size");
+
+int rct_group_init(struct rct_group *g, unsigned n)
+{
+    g->n = 0;
+    g->slot = aligned_alloc(RCT_CACHE_LINE,
+                            (n ? n : 1) * sizeof(struct rct_slot));
+    if (!g->slot)
+        return -1;
+
+    memset(g->slot, 0, n * sizeof(struct rct_slot));
+    g->n = n;
+    return 0;
+}
+
+void rct_group_step(struct rct_group *g, const struct rc_params *p,
+                    uint64_t t_ns)
+{
+    for (unsigned i = 0; i < g->n; i++) {
+        struct rct_slot *s = &g->slot[i];
+
+        s->r.seq++;
+        s->r.t_due_ns = s->r.t_sample_ns = t_ns;
+        rct_sample(&s->c, p, &s->r);
+        rct_model(p, &s->r);
+        s->r.t_model_ns = t_ns;
+        rct_actuate(&s->c, p, &s->r);
+    }
+}
+
+void rct_group_free(struct rct_group *g)
+{
+    free(g->slot);
+    g->slot = NULL;
+    g->n = 0;
+}
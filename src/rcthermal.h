@@ -0,0 +1,146 @@
+/*
+ * librcthermal: RC-model thermal controller
+ *
+ * The pieces rc_sched is built from, usable from other programs:
+ *
+ *   params.h    parameter set, defaults, config file parser
+ *   model.h     RC model (pure functions)
+ *   platform.h  sensor/cpufreq backend interface, sysfs.h the real one
+ *   topology.h  packages, their cpufreq policies, zones and RAPL domains
+ *   trips.h     kernel trip points and thresholds derived from them
+ *   ramp.h      workload ramp detector
+ *   health.h    sensor spike, stuck and staleness filter
+ *
+ * and the controller below. A controller is a plain struct the caller
+ * owns; it holds no pointers to global state and every call takes the
+ * instance and the parameters explicitly, so any number of them can
+ * run in one process, one per thread or stepped from a single loop.
+ * Two controllers must not share a cpufreq policy.
+ *
+ * The one process-wide service is the crash journal (journal.h) every
+ * sysfs write goes through: its point is a single file that a restart
+ * replays. It is locked internally and may be left unopened.
+ *
+ * Link with -lrcthermal -lm -pthread.
+ */
+
+#ifndef RC_THERMAL_H
+#define RC_THERMAL_H
+
+#include "params.h"
+#include "model.h"
+#include "platform.h"
+#include "sysfs.h"
+#include "topology.h"
+#include "trips.h"
+#include "ramp.h"
+#include "health.h"
+#include "sample.h"
+
+#define RCT_API_VERSION     3
+#define RCT_CACHE_LINE      64
+
+/* rct_level() */
+#define RCT_LEVEL_NONE      0
+#define RCT_LEVEL_CAPPED    1       // frequency cap and/or clamp
+#define RCT_LEVEL_IDLE      2       // plus forced idle
+
+/*
+ * Optional actuators beyond the frequency cap. A NULL table (or NULL
+ * entry) means the controller does without. With cool_set, fans are
+ * raised to full before the frequency is capped and lowered only once
+ * the cap is gone; cool_level is read on the sampling side.
+ */
+struct rct_actuator_ops {
+    void (*clamp)(void *ctx, double overshoot);  // °C above t_high
+    void (*unclamp)(void *ctx);
+    void (*idle_set)(void *ctx, double frac);    // 0 stops
+    int  (*idle_pct)(void *ctx);
+    void (*cool_set)(void *ctx, double level);   // 0..1, 0 restores
+    double (*cool_level)(void *ctx);             // level in effect
+};
+
+struct rct_actuators {
+    const struct rct_actuator_ops *ops;
+    void *ctx;
+};
+
+/* Decision messages, `now` on the platform clock */
+typedef void (*rct_note_fn)(void *arg, double now, const char *msg);
+
+struct rct_controller {
+    _Alignas(RCT_CACHE_LINE) struct platform plat;
+    struct rct_actuators act;
+    int clamp_only;                 // leave the frequency cap alone
+    rct_note_fn note;               // NULL: silent
+    void *note_arg;
+
+    /* state, read-only for callers */
+    int mitigation_active;
+    int precapped;                  // early cap from a detected ramp
+    double cooling;                 // fan level asked for, 0..1
+    int was_valid;
+    double last_action_time;
+    int original_max_freq;          // kHz, -1 if unknown
+    int applied_max_freq;           // kHz, -1 if uncapped
+    struct ramp ramp;
+    struct sensor_health health;    // written by rct_sample() only
+};
+
+/* Bind `c` to a backend; `act` may be NULL */
+void rct_init(struct rct_controller *c, const struct platform *plat,
+              const struct rct_actuators *act);
+
+/* Forget mitigation state; does not touch the platform */
+void rct_reset(struct rct_controller *c);
+
+/*
+ * Read the sensors (and the fan level in effect) into `r`. The
+ * temperature is the health filter's, with the sensor_* limits of
+ * `p`: a held value or, with none fresh enough, an invalid sample.
+ */
+void rct_sample(struct rct_controller *c, const struct rc_params *p,
+                struct sample_rec *r);
+
+/* Power estimate and prediction, at r->cooling, for a valid sample */
+void rct_model(const struct rc_params *p, struct sample_rec *r);
+
+/* Fans, hysteresis, early cap and idle injection for one sample */
+void rct_actuate(struct rct_controller *c, const struct rc_params *p,
+                 const struct sample_rec *r);
+
+/* RCT_LEVEL_* */
+int rct_level(const struct rct_controller *c);
+
+/* Idle being injected, percent (0 without an idle actuator) */
+int rct_idle_pct(const struct rct_controller *c);
+
+/* =======================
+   Controller groups
+   ======================= */
+
+/*
+ * A controller and its latest sample. Whole cache lines, so stepping
+ * one never pulls in or dirties a neighbour's.
+ */
+struct rct_slot {
+    struct rct_controller c;
+    struct sample_rec r;
+};
+
+/* Independent controllers (per zone, per policy) stepped together */
+struct rct_group {
+    struct rct_slot *slot;      // n, contiguous, cache-line aligned
+    unsigned n;
+};
+
+/* Allocate n zeroed slots; rct_init() each before stepping. 0 or -1 */
+int rct_group_init(struct rct_group *g, unsigned n);
+
+/* One tick of every controller, in slot order, stamped t_ns */
+void rct_group_step(struct rct_group *g, const struct rc_params *p,
+                    uint64_t t_ns);
+
+void rct_group_free(struct rct_group *g);
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Binary sample recorder
+ *
+ * Encoding works against the values the decoder will reconstruct, not
+ * the raw inputs, so rounding never accumulates across deltas.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "recorder.h"
+#include "rc_record.h"
+
+static struct rec_header *hdr = NULL;
+static union rec_slot *slots;
+static size_t map_size;
+
+/* Last reconstructed state */
+static struct {
+    int have;
+    uint64_t t_us;
+    int32_t temp_cc, pred_cc, freq_mhz, power_cw;
+    int32_t cap_khz;
+    uint8_t uclamp_pct;
+    uint8_t flags;
+    unsigned since_key;
+} prev;
+
+static int64_t clock_ns(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int recorder_open(const char *path, size_t bytes)
+{
+    char dir[256];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash && slash != dir) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+    }
+
+    uint64_t n_slots = (bytes - REC_HEADER_SIZE) / REC_SLOT_SIZE;
+    if (bytes <= REC_HEADER_SIZE || n_slots < 2 * REC_KEY_INTERVAL) {
+        fprintf(stderr, "recorder: log size too small\n");
+        return -1;
+    }
+    map_size = REC_HEADER_SIZE + n_slots * REC_SLOT_SIZE;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, (off_t)map_size) < 0 ||
+        posix_fallocate(fd, 0, (off_t)map_size) != 0) {
+        fprintf(stderr, "recorder: %s: %s\n", path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+
+    void *p = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    /* Each run starts a fresh log; copy the file to keep an old one */
+    hdr = p;
+    slots = (union rec_slot *)((char *)p + REC_HEADER_SIZE);
+    memset(hdr, 0, REC_HEADER_SIZE);
+    hdr->version = REC_VERSION;
+    hdr->slot_size = REC_SLOT_SIZE;
+    hdr->n_slots = n_slots;
+    hdr->mono_base_ns = clock_ns(CLOCK_MONOTONIC);
+    hdr->wall_base_ns = clock_ns(CLOCK_REALTIME);
+    atomic_thread_fence(memory_order_release);
+    hdr->magic = REC_MAGIC;
+
+    memset(&prev, 0, sizeof(prev));
+    return 0;
+}
+
+static union rec_slot *slot_at(uint64_t i)
+{
+    return &slots[i % hdr->n_slots];
+}
+
+static int fits16(int32_t v)
+{
+    return v >= INT16_MIN && v <= INT16_MAX;
+}
+
+static int16_t clamp16(int32_t v)
+{
+    return (int16_t)(v < INT16_MIN ? INT16_MIN : v > INT16_MAX ? INT16_MAX : v);
+}
+
+void recorder_append(const struct rc_telem_data *d, unsigned zone)
+{
+    if (!hdr)
+        return;
+
+    const struct rc_telem_zone *z = &d->zones[zone];
+    uint64_t t_us = d->t_sample_ns / 1000;
+    int32_t temp_cc  = d->valid ? (int32_t)lrint(z->temp_c * 100) : 0;
+    int32_t pred_cc  = d->valid ? (int32_t)lrint(z->pred_c * 100) : 0;
+    int32_t freq_mhz = d->valid ? (int32_t)lrint(d->freq_ghz * 1000) : 0;
+    int32_t power_cw = d->valid ? (int32_t)lrint(d->power_w * 100) : 0;
+    uint8_t util_pct = (uint8_t)lrint(d->util * 100);
+    uint8_t idle_pct = (uint8_t)d->idle_pct;
+    uint8_t uclamp   = (uint8_t)lrint(d->uclamp_pct);
+    uint8_t flags    = (d->valid ? REC_F_VALID : 0) |
+                       ((d->mitigation_level << REC_F_MIT_SHIFT) &
+                        REC_F_MIT_MASK);
+
+    uint64_t w = atomic_load_explicit(&hdr->written, memory_order_relaxed);
+
+    int key = !prev.have ||
+              prev.since_key + 1 >= REC_KEY_INTERVAL ||
+              flags != prev.flags ||
+              d->cap_khz != prev.cap_khz ||
+              uclamp != prev.uclamp_pct ||
+              t_us - prev.t_us > UINT32_MAX ||
+              !fits16(temp_cc - prev.temp_cc) ||
+              !fits16(pred_cc - prev.pred_cc) ||
+              !fits16(freq_mhz - prev.freq_mhz) ||
+              !fits16(power_cw - prev.power_cw);
+
+    if (key) {
+        temp_cc = clamp16(temp_cc);
+        pred_cc = clamp16(pred_cc);
+
+        union rec_slot *a = slot_at(w), *b = slot_at(w + 1);
+
+        a->key = (struct rec_key){
+            .kind = REC_KEY, .flags = flags,
+            .util_pct = util_pct, .idle_pct = idle_pct,
+            .temp_cc = (int16_t)temp_cc, .pred_cc = (int16_t)pred_cc,
+            .t_us = t_us,
+        };
+        b->key2 = (struct rec_key2){
+            .kind = REC_KEY2, .uclamp_pct = uclamp,
+            .freq_mhz = (uint32_t)freq_mhz, .power_cw = power_cw,
+            .cap_khz = d->cap_khz,
+        };
+        atomic_store_explicit(&hdr->written, w + 2, memory_order_release);
+        prev.since_key = 0;
+    }
+    else {
+        slot_at(w)->delta = (struct rec_delta){
+            .kind = REC_DELTA, .flags = flags,
+            .util_pct = util_pct, .idle_pct = idle_pct,
+            .dt_us = (uint32_t)(t_us - prev.t_us),
+            .d_temp_cc = (int16_t)(temp_cc - prev.temp_cc),
+            .d_pred_cc = (int16_t)(pred_cc - prev.pred_cc),
+            .d_freq_mhz = (int16_t)(freq_mhz - prev.freq_mhz),
+            .d_power_cw = (int16_t)(power_cw - prev.power_cw),
+        };
+        atomic_store_explicit(&hdr->written, w + 1, memory_order_release);
+        prev.since_key++;
+    }
+
+    prev.have = 1;
+    prev.t_us = t_us;
+    prev.temp_cc = temp_cc;
+    prev.pred_cc = pred_cc;
+    prev.freq_mhz = freq_mhz;
+    prev.power_cw = power_cw;
+    prev.cap_khz = d->cap_khz;
+    prev.uclamp_pct = uclamp;
+    prev.flags = flags;
+}
+
+void recorder_close(void)
+{
+    if (!hdr)
+        return;
+
+    msync(hdr, map_size, MS_ASYNC);
+    munmap(hdr, map_size);
+    hdr = NULL;
+}
@@ -0,0 +1,28 @@
+/*
+ * Binary sample recorder (format in rc_record.h)
+ */
+
+#ifndef RC_RECORDER_H
+#define RC_RECORDER_H
+
+#include <stddef.h>
+
+#include "rc_telemetry.h"
+
+#define RECORDER_PATH       "/var/lib/rc_sched/samples.rec"
+#define RECORDER_DEFAULT_MB 8
+
+/* Create or reuse a log of `bytes` total size; returns 0 or -1 */
+int recorder_open(const char *path, size_t bytes);
+
+/*
+ * Append one sample; called from the actuator thread only. `zone` is
+ * the zone the scalars (frequency, utilization, power) were taken
+ * from, so the record never pairs one package's temperature with
+ * another's power.
+ */
+void recorder_append(const struct rc_telem_data *d, unsigned zone);
+
+void recorder_close(void);
+
+#endif
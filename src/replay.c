@@ -0,0 +1,346 @@
+/*
+ * Trace replay
+ *
+ * Samples are fed through the same stage functions the pipeline
+ * threads call, serially, with the clock advanced to each sample's
+ * timestamp. The recorded machine did not see the replayed decisions,
+ * so a cap is applied to the recorded frequency and its effect on
+ * temperature is estimated with the RC model: the power it removes
+ * drives a correction dT that is added to the recorded temperature.
+ *
+ * Traces are loaded whole so that sweeps parse them once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include "replay.h"
+#include "platform.h"
+#include "controller.h"
+#include "config.h"
+#include "idle_inject.h"
+#include "rc_record.h"
+
+#define REPLAY_DEFAULT_UTIL 0.7     // traces without a utilization column
+
+/* Virtual machine state seen by the control stages */
+static struct {
+    const struct replay_point *cur;
+    double temp_c, freq_ghz;        // what the controller sees
+    double dT;                      // model correction for the cap
+    int policy_max_khz;             // highest frequency seen so far
+    int cap_khz;                    // 0 when uncapped
+    unsigned long long writes;      // cap and restore writes
+} vm;
+
+/* =======================
+   Trace input
+   ======================= */
+static int append(struct replay_trace *tr, size_t *cap,
+                  const struct replay_point *pt)
+{
+    if (tr->n == *cap) {
+        size_t ncap = *cap ? *cap * 2 : 65536;
+        struct replay_point *p = realloc(tr->pts, ncap * sizeof(*p));
+        if (!p)
+            return -1;
+        tr->pts = p;
+        *cap = ncap;
+    }
+    tr->pts[tr->n++] = *pt;
+    return 0;
+}
+
+static int load_log(struct replay_trace *tr, const char *path)
+{
+    struct rec_reader *r = rec_reader_open(path);
+    if (!r)
+        return -1;
+
+    struct rec_sample s;
+    size_t cap = 0;
+    while (rec_reader_next(r, &s)) {
+        struct replay_point pt = {
+            .t = s.t_us / 1e6,
+            .temp_c = s.valid ? (float)s.temp_c : -1.0f,
+            .freq_ghz = (float)s.freq_ghz,
+            .util = (float)s.util,
+        };
+        if (append(tr, &cap, &pt) < 0) {
+            rec_reader_close(r);
+            return -1;
+        }
+    }
+
+    rec_reader_close(r);
+    return 0;
+}
+
+static int load_text(struct replay_trace *tr, FILE *fp)
+{
+    char line[256];
+    size_t cap = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        double f[4];
+        int n = 0;
+        char *s = line, *end;
+
+        while (n < 4) {
+            while (*s == ' ' || *s == '\t' || *s == ',')
+                s++;
+            f[n] = strtod(s, &end);
+            if (end == s)
+                break;
+            s = end;
+            n++;
+        }
+        if (n < 3)
+            continue;           // comment, header or blank line
+
+        struct replay_point pt = {
+            .t = f[0],
+            .temp_c = f[2] < 0 ? -1.0f : (float)f[1],
+            .freq_ghz = (float)f[2],
+            .util = (float)(n > 3 ? f[3] : REPLAY_DEFAULT_UTIL),
+        };
+        if (append(tr, &cap, &pt) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+struct replay_trace *replay_load(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return NULL;
+
+    struct replay_trace *tr = calloc(1, sizeof(*tr));
+    if (!tr) {
+        fclose(fp);
+        return NULL;
+    }
+
+    uint32_t magic = 0;
+    int rc;
+    if (fread(&magic, sizeof(magic), 1, fp) == 1 && magic == REC_MAGIC) {
+        fclose(fp);
+        rc = load_log(tr, path);
+    }
+    else {
+        rewind(fp);
+        rc = load_text(tr, fp);
+        fclose(fp);
+    }
+
+    if (rc < 0) {
+        replay_free(tr);
+        return NULL;
+    }
+    return tr;
+}
+
+void replay_free(struct replay_trace *tr)
+{
+    if (!tr)
+        return;
+    free(tr->pts);
+    free(tr);
+}
+
+/* =======================
+   Virtual platform
+   ======================= */
+static double vm_temperature(void *ctx)
+{
+    (void)ctx;
+    return vm.temp_c;
+}
+
+static double vm_frequency(void *ctx)
+{
+    (void)ctx;
+    return vm.freq_ghz;
+}
+
+static double vm_utilization(void *ctx)
+{
+    (void)ctx;
+    return vm.cur->util;
+}
+
+static int vm_read_max_frequency(void *ctx)
+{
+    (void)ctx;
+    return vm.cap_khz ? vm.cap_khz : vm.policy_max_khz;
+}
+
+static void vm_write_max_frequency(void *ctx, int khz)
+{
+    (void)ctx;
+    vm.cap_khz = khz < vm.policy_max_khz ? khz : 0;
+    vm.writes++;
+}
+
+static int vm_restore_max_frequency(void *ctx)
+{
+    (void)ctx;
+    if (!vm.cap_khz)
+        return -1;
+    vm.cap_khz = 0;
+    vm.writes++;
+    return 0;
+}
+
+static double vm_now(void *ctx)
+{
+    (void)ctx;
+    return vm.cur->t;
+}
+
+static const struct platform_ops replay_platform = {
+    .read_temperature      = vm_temperature,
+    .read_frequency        = vm_frequency,
+    .read_utilization      = vm_utilization,
+    .read_max_frequency    = vm_read_max_frequency,
+    .write_max_frequency   = vm_write_max_frequency,
+    .restore_max_frequency = vm_restore_max_frequency,
+    .now                   = vm_now,
+};
+
+/* =======================
+   Replay loop
+   ======================= */
+void replay_run(const struct replay_trace *tr,
+                const struct pipeline_ops *ops,
+                const struct rc_params *plant, struct replay_result *res)
+{
+    const struct rc_params *p = params_get();
+    double cap_sum = 0.0, limit_sum = 0.0, idle_sum = 0.0;
+    double work = 0.0, work_kept = 0.0;
+    double tau = plant->r_thermal * plant->c_thermal;
+    double prev_T = 0.0;
+    int prev_valid = 0, prev_idle = 0;
+
+    memset(&vm, 0, sizeof(vm));
+    memset(res, 0, sizeof(*res));
+    idle_inject_init_virtual();
+    controller_platform(&replay_platform, NULL);
+
+    for (size_t i = 0; i < tr->n; i++) {
+        vm.cur = &tr->pts[i];
+
+        int khz = (int)(vm.cur->freq_ghz * 1e6f + 0.5f);
+        if (vm.cur->temp_c >= 0 && khz > vm.policy_max_khz)
+            vm.policy_max_khz = khz;
+
+        /* The state left by the previous decision held until now */
+        double dt = i ? vm.cur->t - tr->pts[i - 1].t : 0.0;
+        if (dt > 0) {
+            res->span += dt;
+            if (prev_valid && prev_T > p->t_high)
+                res->above_high += dt;
+            if (vm.cap_khz) {
+                res->capped += dt;
+                cap_sum += vm.cap_khz * dt;
+            }
+            limit_sum += dt * (vm.cap_khz && vm.policy_max_khz ?
+                (double)vm.cap_khz / vm.policy_max_khz : 1.0);
+            if (prev_idle) {
+                res->idle += dt;
+                idle_sum += prev_idle * dt;
+            }
+
+            /* Cycles and heat the limits took out since the last sample */
+            const struct replay_point *pv = &tr->pts[i - 1];
+            if (pv->temp_c >= 0) {
+                double f_kept = pv->freq_ghz;
+                if (vm.cap_khz && vm.cap_khz / 1e6 < f_kept)
+                    f_kept = vm.cap_khz / 1e6;
+                f_kept *= 1.0 - prev_idle / 100.0;
+                double dP = plant->alpha * pv->util * (f_kept - pv->freq_ghz);
+                double dT_inf = dP * plant->r_thermal;
+                vm.dT = dT_inf + (vm.dT - dT_inf) * exp(-dt / tau);
+                work += pv->util * pv->freq_ghz * dt;
+                work_kept += pv->util * f_kept * dt;
+            }
+        }
+
+        if (vm.cur->temp_c >= 0) {
+            double f_lim = vm.cap_khz ? vm.cap_khz / 1e6 : vm.cur->freq_ghz;
+            vm.freq_ghz = vm.cur->freq_ghz < f_lim ? vm.cur->freq_ghz : f_lim;
+            vm.temp_c = vm.cur->temp_c + vm.dT;
+        }
+        else {
+            vm.freq_ghz = vm.temp_c = -1.0;
+        }
+
+        uint64_t t_ns = (uint64_t)(vm.cur->t * 1e9);
+        struct sample_rec r;
+        memset(&r, 0, sizeof(r));
+        r.seq = i;
+        r.t_due_ns = r.t_sample_ns = r.t_model_ns = t_ns;
+
+        ops->sample(&r);
+        ops->model(&r);
+        ops->actuate(&r);
+
+        int idle = idle_inject_pct(0);
+        if (idle && !prev_idle)
+            res->idle_starts++;
+        if (r.valid && (res->samples == res->invalid || r.T_curr > res->peak))
+            res->peak = r.T_curr;
+
+        res->samples++;
+        res->invalid += !r.valid;
+        prev_valid = r.valid;
+        prev_T = r.T_curr;
+        prev_idle = idle;
+    }
+
+    res->cap_writes = vm.writes;
+    res->cap_avg_khz = res->capped > 0 ? cap_sum / res->capped : 0.0;
+    res->limit_share = res->span > 0 ? limit_sum / res->span : 1.0;
+    res->work_share = work > 0 ? work_kept / work : 1.0;
+    res->idle_avg_pct = res->idle > 0 ? idle_sum / res->idle : 0.0;
+
+    idle_inject_stop();
+    controller_platform(NULL, NULL);
+}
+
+void replay_print(const struct replay_result *res, double elapsed_s)
+{
+    double span = res->span;
+
+    printf("\nReplay summary\n");
+    printf("  samples          %llu (%llu invalid)\n",
+           res->samples, res->invalid);
+    printf("  trace duration   %.1f s, replayed in %.2f s (%.0fx)\n",
+           span, elapsed_s, elapsed_s > 0 ? span / elapsed_s : 0.0);
+    if (span <= 0)
+        return;
+
+    printf("  peak T           %.2f °C\n", res->peak);
+    printf("  time > T_HIGH    %.1f s (%.2f%%)\n",
+           res->above_high, 100.0 * res->above_high / span);
+    printf("  capped           %.1f s (%.2f%%)",
+           res->capped, 100.0 * res->capped / span);
+    if (res->capped > 0)
+        printf(", average cap %.0f kHz", res->cap_avg_khz);
+    printf("\n");
+    printf("  average limit    %.1f%% of max frequency\n",
+           100.0 * res->limit_share);
+    printf("  work retained    %.2f%% of recorded cycles\n",
+           100.0 * res->work_share);
+    printf("  idle injection   %.1f s", res->idle);
+    if (res->idle > 0)
+        printf(", average %.0f%%", res->idle_avg_pct);
+    printf("\n");
+    printf("  actions          %llu cap/restore writes, %llu idle "
+           "injections\n", res->cap_writes, res->idle_starts);
+}
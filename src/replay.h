@@ -0,0 +1,60 @@
+/*
+ * Trace replay: drive the control stages from recorded samples
+ */
+
+#ifndef RC_REPLAY_H
+#define RC_REPLAY_H
+
+#include <stddef.h>
+
+#include "pipeline.h"
+#include "config.h"
+
+struct replay_point {
+    double t;                       // s
+    float temp_c;                   // < 0: sensor read failed
+    float freq_ghz;
+    float util;
+};
+
+struct replay_trace {
+    size_t n;
+    struct replay_point *pts;
+};
+
+struct replay_result {
+    unsigned long long samples, invalid;
+    unsigned long long cap_writes, idle_starts;
+    double span;                    // s of trace time
+    double peak;                    // °C, recorded + cap correction
+    double above_high;              // s with T_curr > t_high
+    double capped, cap_avg_khz;     // s capped, mean cap while capped
+    double limit_share;             // time-mean of limit / policy max
+    double work_share;              // cycles kept / cycles recorded
+    double idle, idle_avg_pct;      // s injecting, mean while injecting
+};
+
+/*
+ * Load a whole trace: a binary sample log (rc_record.h) or text with
+ * one "t_s temp_c freq_ghz [util]" sample per line (commas or blanks,
+ * '#' comments and non-numeric header lines skipped).
+ * NULL with errno set if it cannot be read.
+ */
+struct replay_trace *replay_load(const char *path);
+
+void replay_free(struct replay_trace *tr);
+
+/*
+ * Feed every sample through ops->sample/model/actuate on a virtual
+ * clock, as fast as possible, scoring against the active parameters.
+ * `plant` supplies the RC model that estimates how much cooler the
+ * machine would have run under the replayed caps.
+ * Not reentrant: the controller and platform are process-wide.
+ */
+void replay_run(const struct replay_trace *tr,
+                const struct pipeline_ops *ops,
+                const struct rc_params *plant, struct replay_result *res);
+
+void replay_print(const struct replay_result *res, double elapsed_s);
+
+#endif
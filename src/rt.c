@@ -0,0 +1,63 @@
+/*
+ * Real-time mode for the control loop threads
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include "rt.h"
+
+int rt_lock_memory(void)
+{
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        fprintf(stderr, "rt: mlockall failed: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* noinline: the frame has to be below the caller's, not merged into it */
+__attribute__((noinline)) void rt_prefault_stack(void)
+{
+    volatile unsigned char buf[RT_PREFAULT_STACK];
+    long page = sysconf(_SC_PAGESIZE);
+
+    for (long i = 0; i < RT_PREFAULT_STACK; i += page)
+        buf[i] = 0;
+    __asm__ __volatile__("" : : "r"(buf) : "memory");
+}
+
+int rt_setup_thread(int prio, int cpu)
+{
+    int rc = 0;
+
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err) {
+            fprintf(stderr, "rt: cannot pin to cpu%d: %s\n",
+                    cpu, strerror(err));
+            rc = -1;
+        }
+    }
+
+    if (prio > 0) {
+        struct sched_param sp = { .sched_priority = prio };
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (err) {
+            fprintf(stderr, "rt: SCHED_FIFO %d refused: %s\n",
+                    prio, strerror(err));
+            rc = -1;
+        }
+    }
+
+    return rc;
+}
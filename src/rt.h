@@ -0,0 +1,30 @@
+/*
+ * Real-time mode for the control loop threads
+ *
+ * Thermal trouble comes with heavy load, which is exactly when a
+ * SCHED_OTHER daemon gets its wakeups delayed. RT mode locks memory,
+ * runs the pipeline under SCHED_FIFO and keeps every daemon thread on
+ * one housekeeping CPU.
+ */
+
+#ifndef RC_RT_H
+#define RC_RT_H
+
+#define RT_PREFAULT_STACK   (64 * 1024)
+#define RT_THREAD_STACK     (256 * 1024)
+
+struct rt_config {
+    int prio;       // SCHED_FIFO priority, 0 = RT mode off
+    int cpu;        // housekeeping CPU, -1 = no pinning
+};
+
+/* mlockall() current and future mappings */
+int rt_lock_memory(void);
+
+/* Touch RT_PREFAULT_STACK bytes of the calling thread's stack */
+void rt_prefault_stack(void);
+
+/* Pin and/or set SCHED_FIFO on the calling thread */
+int rt_setup_thread(int prio, int cpu);
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * One control-loop sample as it travels from sensors to actuators
+ */
+
+#ifndef RC_SAMPLE_H
+#define RC_SAMPLE_H
+
+#include <stdint.h>
+
+#define SAMPLE_MAX_PKG  8
+
+/* One package's readings when the daemon runs a controller per package */
+struct pkg_sample {
+    double T_curr;
+    double freq;
+    double util;
+    double power;
+    double T_pred;
+    double cooling;
+    int32_t valid;
+    int32_t pad;
+};
+
+/*
+ * The scalar fields describe the sample the controller acted on; with
+ * several packages, the one predicted hottest, and pkg[] holds all.
+ */
+struct sample_rec {
+    uint64_t seq;
+    uint64_t t_due_ns;      // intended tick (CLOCK_MONOTONIC)
+    uint64_t t_sample_ns;   // sensors read
+    uint64_t t_model_ns;    // prediction done
+    double T_curr;          // °C
+    double freq;            // GHz
+    double util;            // 0..1
+    double power;           // W
+    double T_pred;          // °C
+    double cooling;         // fan level 0..1 the prediction assumed
+    int32_t valid;          // sensors read successfully
+    uint32_t cpu_ns;        // rc_sched's own cost, summed over stages
+    uint32_t syscalls;
+    uint32_t csw;           // voluntary + involuntary context switches
+    uint32_t n_pkg;         // 0: single controller, pkg[] unused
+    struct pkg_sample pkg[SAMPLE_MAX_PKG];
+};
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * Self-overhead accounting
+ *
+ * Syscalls are counted with a per-thread raw_syscalls:sys_enter perf
+ * counter; without tracefs or with a restrictive perf_event_paranoid
+ * they are reported as n/a. The accounting's own syscalls (the thread
+ * CPU clock, getrusage and the counter read) are left out of the
+ * count; its CPU time is not.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "selfstat.h"
+
+#define SELF_SYSCALLS   3       // made by each charge, before the read
+
+struct sum_stat {
+    atomic_ullong count, total, max;
+};
+
+static struct {
+    struct sum_stat cpu_ns, syscalls, csw, rss_kb;
+    atomic_int syscalls_off;
+} stats;
+
+static _Thread_local struct {
+    uint64_t cpu_ns, csw, syscalls;
+    int perf_fd;
+} tl = { .perf_fd = -1 };
+
+static uint64_t ticks;          // actuator only
+static int statm_fd = -1;
+static long page_kb;
+
+static const char *const tracepoint_ids[] = {
+    "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+    "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+};
+
+/* Single writer: plain load/store instead of locked read-modify-write */
+static void sum_add(struct sum_stat *s, uint64_t v)
+{
+    atomic_store_explicit(&s->count,
+        atomic_load_explicit(&s->count, memory_order_relaxed) + 1,
+        memory_order_relaxed);
+    atomic_store_explicit(&s->total,
+        atomic_load_explicit(&s->total, memory_order_relaxed) + v,
+        memory_order_relaxed);
+    if (v > atomic_load_explicit(&s->max, memory_order_relaxed))
+        atomic_store_explicit(&s->max, v, memory_order_relaxed);
+}
+
+static void sum_get(struct sum_stat *s, double *avg, double *max)
+{
+    unsigned long long n = atomic_load_explicit(&s->count,
+                                                memory_order_relaxed);
+    *avg = n ? atomic_load_explicit(&s->total, memory_order_relaxed) /
+               (double)n : 0.0;
+    *max = (double)atomic_load_explicit(&s->max, memory_order_relaxed);
+}
+
+static int syscall_counter_open(void)
+{
+    long id = -1;
+    for (size_t i = 0; i < sizeof(tracepoint_ids) / sizeof(*tracepoint_ids);
+         i++) {
+        FILE *fp = fopen(tracepoint_ids[i], "r");
+        if (!fp)
+            continue;
+        if (fscanf(fp, "%ld", &id) != 1)
+            id = -1;
+        fclose(fp);
+        if (id >= 0)
+            break;
+    }
+    if (id < 0)
+        return -1;
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_TRACEPOINT;
+    attr.size = sizeof(attr);
+    attr.config = (uint64_t)id;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                        PERF_FLAG_FD_CLOEXEC);
+}
+
+/* Current totals of the calling thread */
+static void thread_read(uint64_t *cpu_ns, uint64_t *csw, uint64_t *sys)
+{
+    struct timespec ts;
+    struct rusage ru;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    *cpu_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+    getrusage(RUSAGE_THREAD, &ru);
+    *csw = (uint64_t)(ru.ru_nvcsw + ru.ru_nivcsw);
+
+    *sys = 0;
+    if (tl.perf_fd >= 0 &&
+        read(tl.perf_fd, sys, sizeof(*sys)) != sizeof(*sys))
+        *sys = 0;
+}
+
+void selfstat_thread_init(void)
+{
+    tl.perf_fd = syscall_counter_open();
+    if (tl.perf_fd < 0)
+        atomic_store(&stats.syscalls_off, 1);
+
+    thread_read(&tl.cpu_ns, &tl.csw, &tl.syscalls);
+}
+
+static uint32_t sat32(uint64_t v)
+{
+    return v > UINT32_MAX ? UINT32_MAX : (uint32_t)v;
+}
+
+void selfstat_charge(struct sample_rec *r)
+{
+    uint64_t cpu, csw, sys;
+    thread_read(&cpu, &csw, &sys);
+
+    r->cpu_ns = sat32(r->cpu_ns + (cpu - tl.cpu_ns));
+    r->csw = sat32(r->csw + (csw - tl.csw));
+    if (sys >= tl.syscalls + SELF_SYSCALLS)
+        r->syscalls = sat32(r->syscalls + sys - tl.syscalls - SELF_SYSCALLS);
+
+    tl.cpu_ns = cpu;
+    tl.csw = csw;
+    tl.syscalls = sys;
+}
+
+static void sample_rss(void)
+{
+    char buf[64];
+
+    if (statm_fd < 0) {
+        statm_fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC);
+        page_kb = sysconf(_SC_PAGESIZE) / 1024;
+        if (statm_fd < 0)
+            return;
+    }
+
+    ssize_t n = pread(statm_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0)
+        return;
+    buf[n] = '\0';
+
+    unsigned long size, resident;
+    if (sscanf(buf, "%lu %lu", &size, &resident) == 2)
+        sum_add(&stats.rss_kb, (uint64_t)resident * page_kb);
+}
+
+void selfstat_tick(const struct sample_rec *r)
+{
+    if (++ticks <= SELFSTAT_WARMUP)
+        return;
+
+    sum_add(&stats.cpu_ns, r->cpu_ns);
+    sum_add(&stats.syscalls, r->syscalls);
+    sum_add(&stats.csw, r->csw);
+
+    if ((ticks - SELFSTAT_WARMUP - 1) % SELFSTAT_RSS_EVERY == 0)
+        sample_rss();
+}
+
+void selfstat_get(struct selfstat *s)
+{
+    double avg, max;
+
+    memset(s, 0, sizeof(*s));
+    s->ticks = atomic_load_explicit(&stats.cpu_ns.count,
+                                    memory_order_relaxed);
+
+    sum_get(&stats.cpu_ns, &avg, &max);
+    s->cpu_us_avg = avg / 1e3;
+    s->cpu_us_max = max / 1e3;
+
+    s->syscalls_ok = !atomic_load(&stats.syscalls_off);
+    sum_get(&stats.syscalls, &s->syscalls_avg, &s->syscalls_max);
+    sum_get(&stats.csw, &s->csw_avg, &s->csw_max);
+    sum_get(&stats.rss_kb, &s->rss_kb_avg, &s->rss_kb_max);
+}
+
+void selfstat_report(struct ctl_reply *r)
+{
+    struct selfstat s;
+    selfstat_get(&s);
+
+    ctl_printf(r, "overhead ticks=%llu cpu_us_avg=%.1f cpu_us_max=%.1f ",
+               (unsigned long long)s.ticks, s.cpu_us_avg, s.cpu_us_max);
+    if (s.syscalls_ok)
+        ctl_printf(r, "syscalls_avg=%.1f syscalls_max=%.0f ",
+                   s.syscalls_avg, s.syscalls_max);
+    else
+        ctl_printf(r, "syscalls=n/a ");
+    ctl_printf(r, "csw_avg=%.2f csw_max=%.0f rss_kb_avg=%.0f "
+               "rss_kb_max=%.0f\n",
+               s.csw_avg, s.csw_max, s.rss_kb_avg, s.rss_kb_max);
+}
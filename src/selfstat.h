@@ -0,0 +1,46 @@
+/*
+ * Self-overhead accounting
+ *
+ * A thermal controller that burns CPU heats the part it is cooling, so
+ * every pipeline stage charges what it spent on a record to that
+ * record: thread CPU time, syscalls and context switches since the
+ * stage's previous charge. The actuator folds the per-tick totals into
+ * running averages and maxima, and samples resident memory now and then.
+ */
+
+#ifndef RC_SELFSTAT_H
+#define RC_SELFSTAT_H
+
+#include <stdint.h>
+
+#include "sample.h"
+#include "control.h"
+
+/* Ticks not counted: thread startup and prefaulting land in them */
+#define SELFSTAT_WARMUP     2
+#define SELFSTAT_RSS_EVERY  64      // ticks between /proc/self/statm reads
+
+struct selfstat {
+    uint64_t ticks;
+    double   cpu_us_avg, cpu_us_max;
+    int      syscalls_ok;           // 0: no raw_syscalls tracepoint access
+    double   syscalls_avg, syscalls_max;
+    double   csw_avg, csw_max;
+    double   rss_kb_avg, rss_kb_max;
+};
+
+/* Take the calling thread's baseline; once at the start of each stage */
+void selfstat_thread_init(void);
+
+/* Add what the calling thread spent since its last charge to `r` */
+void selfstat_charge(struct sample_rec *r);
+
+/* Actuator: account one finished record */
+void selfstat_tick(const struct sample_rec *r);
+
+void selfstat_get(struct selfstat *s);
+
+/* One "overhead" line for the status command */
+void selfstat_report(struct ctl_reply *r);
+
+#endif
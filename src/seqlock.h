@@ -0,0 +1,42 @@
+/*
+ * Sequence lock for single-writer, many-reader snapshots
+ *
+ * The writer bumps the counter to odd, updates, bumps it to even.
+ * Readers copy the data and retry if the counter moved or was odd;
+ * they never write shared memory, so the writer never waits for them.
+ */
+
+#ifndef RC_SEQLOCK_H
+#define RC_SEQLOCK_H
+
+#include <stdatomic.h>
+
+static inline void seq_write_begin(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seq_write_end(atomic_uint *seq)
+{
+    unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+    atomic_store_explicit(seq, s + 1, memory_order_release);
+}
+
+static inline unsigned seq_read_begin(atomic_uint *seq)
+{
+    unsigned s;
+    while ((s = atomic_load_explicit(seq, memory_order_acquire)) & 1)
+        ;
+    return s;
+}
+
+/* Non-zero if the data copied since seq_read_begin() may be torn */
+static inline int seq_read_retry(atomic_uint *seq, unsigned start)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(seq, memory_order_relaxed) != start;
+}
+
+#endif
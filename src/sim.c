@@ -0,0 +1,268 @@
+/*
+ * Closed-loop plant simulator
+ *
+ * The plant is integrated exactly over each step (constant power
+ * within a step). Work arrives at the workload's rate into a backlog
+ * and is served at the effective frequency, so a cap shows up as lost
+ * throughput rather than as a changed demand.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim.h"
+#include "platform.h"
+#include "controller.h"
+#include "config.h"
+#include "idle_inject.h"
+
+static struct {
+    const struct sim_config *c;
+    double t;
+    double T;                   // plant temperature
+    double f;                   // effective frequency, GHz
+    int hw_max_khz;
+    int limit_khz;              // scaling_max_freq in force
+    int pending_khz;            // written, not yet in force (0 = none)
+    double pending_at;
+    double util;                // over the last control period
+    double busy, avail;         // Gcycles this control period
+    double backlog;             // Gcycles
+    double demand;              // share of f_max, current phase
+    double phase_end;
+    int burst;
+    uint64_t rng;
+    unsigned long long writes;
+} s;
+
+static double uniform(void)
+{
+    s.rng ^= s.rng >> 12;
+    s.rng ^= s.rng << 25;
+    s.rng ^= s.rng >> 27;
+    return ((s.rng * 0x2545F4914F6CDD1DULL) >> 11) * 0x1.0p-53;
+}
+
+static double exponential(double mean)
+{
+    return -mean * log(1.0 - uniform());
+}
+
+/* =======================
+   Workload
+   ======================= */
+static void workload_update(void)
+{
+    const struct sim_config *c = s.c;
+
+    switch (c->workload) {
+    case SIM_STEADY:
+        s.demand = c->level;
+        break;
+    case SIM_BURSTY:
+        while (s.t >= s.phase_end) {
+            s.burst = !s.burst;
+            s.phase_end += exponential(s.burst ? c->burst_s : c->gap_s);
+        }
+        s.demand = s.burst ? c->level : c->low;
+        break;
+    case SIM_DIURNAL:
+        s.demand = c->low + (c->level - c->low) *
+                   (0.5 - 0.5 * cos(2 * M_PI * s.t / c->period));
+        break;
+    }
+}
+
+/* =======================
+   Platform seen by the controller
+   ======================= */
+static double sim_temperature(void *ctx)
+{
+    (void)ctx;
+    double noise = s.c->sensor_noise * (2.0 * uniform() - 1.0);
+    return floor((s.T + noise) * 1000.0) / 1000.0;     // millidegrees
+}
+
+static double sim_frequency(void *ctx)
+{
+    (void)ctx;
+    return s.f;
+}
+
+static double sim_utilization(void *ctx)
+{
+    (void)ctx;
+    return s.util;
+}
+
+static int sim_read_max_frequency(void *ctx)
+{
+    (void)ctx;
+    return s.pending_khz ? s.pending_khz : s.limit_khz;
+}
+
+static void sim_write_max_frequency(void *ctx, int khz)
+{
+    (void)ctx;
+    if (khz > s.hw_max_khz)
+        khz = s.hw_max_khz;
+    s.pending_khz = khz;
+    s.pending_at = s.t + s.c->transition_s;
+    s.writes++;
+}
+
+static int sim_restore_max_frequency(void *ctx)
+{
+    if (sim_read_max_frequency(ctx) >= s.hw_max_khz)
+        return -1;
+    sim_write_max_frequency(ctx, s.hw_max_khz);
+    return 0;
+}
+
+static double sim_now(void *ctx)
+{
+    (void)ctx;
+    return s.t;
+}
+
+static const struct platform_ops sim_platform = {
+    .read_temperature      = sim_temperature,
+    .read_frequency        = sim_frequency,
+    .read_utilization      = sim_utilization,
+    .read_max_frequency    = sim_read_max_frequency,
+    .write_max_frequency   = sim_write_max_frequency,
+    .restore_max_frequency = sim_restore_max_frequency,
+    .now                   = sim_now,
+};
+
+/* =======================
+   Plant
+   ======================= */
+static void plant_step(double h, const struct rc_params *p,
+                       struct sim_result *res)
+{
+    const struct sim_config *c = s.c;
+
+    if (s.pending_khz && s.t >= s.pending_at) {
+        s.limit_khz = s.pending_khz;
+        s.pending_khz = 0;
+    }
+    s.f = s.limit_khz / 1e6;
+
+    workload_update();
+    double arrive = s.demand * c->f_max_ghz * h;
+    s.backlog += arrive;
+    res->offered += arrive;
+
+    double capacity = s.f * (1.0 - idle_inject_pct(0) / 100.0) * h;
+    double served = s.backlog < capacity ? s.backlog : capacity;
+    s.backlog -= served;
+    res->delivered += served;
+    s.busy += served;
+    s.avail += s.f * h;
+
+    double util = s.f > 0 ? served / (s.f * h) : 0.0;
+    double P = c->p_static + c->c_dyn * s.f * s.f * s.f * util;
+    double T_inf = c->t_ambient + P * c->r_thermal;
+    s.T = T_inf + (s.T - T_inf) * exp(-h / (c->r_thermal * c->c_thermal));
+
+    if (s.T > res->peak_temp) res->peak_temp = s.T;
+    if (s.T > p->t_high) res->above_high += h;
+    if (s.T > p->t_critical) res->above_critical += h;
+    if (s.limit_khz < s.hw_max_khz) res->capped += h;
+    res->mean_temp += s.T * h;
+
+    s.t += h;
+}
+
+/* =======================
+   Public API
+   ======================= */
+void sim_defaults(struct sim_config *c)
+{
+    memset(c, 0, sizeof(*c));
+    c->r_thermal = 3.5;
+    c->c_thermal = 20.0;
+    c->t_ambient = 30.0;
+    c->t_start = 40.0;
+    c->p_static = 2.0;
+    c->c_dyn = 1.0;
+    c->sensor_noise = 0.1;
+    c->f_max_ghz = 2.4;
+    c->transition_s = 0.01;
+    c->workload = SIM_STEADY;
+    c->level = 0.9;
+    c->low = 0.1;
+    c->burst_s = 30.0;
+    c->gap_s = 60.0;
+    c->period = 3600.0;
+    c->duration = 3600.0;
+    c->control_period = 1.0;
+    c->step = 0.01;
+    c->seed = 1;
+}
+
+int sim_workload_parse(const char *name)
+{
+    if (!strcmp(name, "steady"))  return SIM_STEADY;
+    if (!strcmp(name, "bursty"))  return SIM_BURSTY;
+    if (!strcmp(name, "diurnal")) return SIM_DIURNAL;
+    return -1;
+}
+
+void sim_run(const struct sim_config *c, const struct pipeline_ops *ops,
+             struct sim_result *res)
+{
+    const struct rc_params *p = params_get();
+
+    memset(&s, 0, sizeof(s));
+    memset(res, 0, sizeof(*res));
+    s.c = c;
+    s.T = c->t_start;
+    s.hw_max_khz = (int)(c->f_max_ghz * 1e6 + 0.5);
+    s.limit_khz = s.hw_max_khz;
+    s.f = c->f_max_ghz;
+    s.rng = 0x9E3779B97F4A7C15ULL ^ c->seed;
+    workload_update();
+    s.util = s.demand;
+
+    idle_inject_init_virtual();
+    controller_platform(&sim_platform, NULL);
+
+    int steps = (int)(c->control_period / c->step + 0.5);
+    if (steps < 1)
+        steps = 1;
+    double h = c->control_period / steps;
+
+    struct sample_rec r;
+    memset(&r, 0, sizeof(r));
+    int prev_idle = 0;
+
+    while (s.t < c->duration) {
+        r.seq++;
+        r.t_due_ns = r.t_sample_ns = r.t_model_ns =
+            (uint64_t)(s.t * 1e9);
+        ops->sample(&r);
+        ops->model(&r);
+        ops->actuate(&r);
+
+        int idle = idle_inject_pct(0);
+        if (idle && !prev_idle)
+            res->idle_starts++;
+        prev_idle = idle;
+
+        s.busy = s.avail = 0.0;
+        for (int i = 0; i < steps && s.t < c->duration; i++)
+            plant_step(h, p, res);
+        s.util = s.avail > 0 ? s.busy / s.avail : 0.0;
+    }
+
+    res->duration = s.t;
+    if (s.t > 0)
+        res->mean_temp /= s.t;
+    res->cap_writes = s.writes;
+
+    idle_inject_stop();
+    controller_platform(NULL, NULL);
+}
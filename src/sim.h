@@ -0,0 +1,72 @@
+/*
+ * Closed-loop plant simulator
+ *
+ * A first-order RC thermal plant heated by a cubic power law, a
+ * cpufreq policy that follows scaling_max_freq after a transition
+ * delay, and a workload that offers cycles at a time-varying rate.
+ * It installs itself as the platform, so the unmodified controller
+ * stages see plausible sensors and their writes change the plant.
+ */
+
+#ifndef RC_SIM_H
+#define RC_SIM_H
+
+#include "pipeline.h"
+
+enum sim_workload {
+    SIM_STEADY,         // constant demand
+    SIM_BURSTY,         // on/off phases of random length
+    SIM_DIURNAL,        // one raised-cosine day over `period`
+};
+
+struct sim_config {
+    /* plant */
+    double r_thermal;           // K/W
+    double c_thermal;           // J/K
+    double t_ambient;           // °C
+    double t_start;             // °C
+    double p_static;            // W at any frequency
+    double c_dyn;               // W per GHz^3 at full utilization
+    double sensor_noise;        // °C, uniform ±
+    /* cpufreq */
+    double f_max_ghz;
+    double transition_s;        // delay before a new limit takes effect
+    /* workload, as a share of f_max */
+    enum sim_workload workload;
+    double level;               // steady level, burst/peak level
+    double low;                 // between bursts / at night
+    double burst_s, gap_s;      // mean burst and gap length
+    double period;              // diurnal period, s
+    /* run */
+    double duration;            // s
+    double control_period;      // s between control decisions
+    double step;                // plant integration step, s
+    unsigned seed;
+};
+
+struct sim_result {
+    double duration;            // s
+    double offered;             // Gcycles the workload asked for
+    double delivered;           // Gcycles executed (∫ f × util dt)
+    double peak_temp;           // °C, true plant temperature
+    double mean_temp;
+    double above_high;          // s with T > t_high
+    double above_critical;      // s with T > t_critical
+    double capped;              // s with a frequency limit in force
+    unsigned long long cap_writes, idle_starts;
+};
+
+void sim_defaults(struct sim_config *c);
+
+/* Parse "steady", "bursty" or "diurnal"; -1 if unknown */
+int sim_workload_parse(const char *name);
+
+/*
+ * Run the stages in `ops` against the plant for c->duration seconds
+ * of simulated time, scoring against the active parameter set.
+ * Not reentrant: the controller and platform are process-wide.
+ */
+void sim_run(const struct sim_config *c, const struct pipeline_ops *ops,
+             struct sim_result *res);
+
+#endif
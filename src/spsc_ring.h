@@ -0,0 +1,132 @@
+/*
+ * Lock-free single-producer/single-consumer ring of sample records
+ *
+ * head is only written by the producer, tail only by the consumer;
+ * each lives on its own cache line so the two sides never share one.
+ * A consumer with nothing to do announces itself in `waiting` and
+ * sleeps on the `wake_seq` futex; the producer bumps it and issues a
+ * wake only when that flag is set, so a busy pipeline makes no
+ * syscalls.
+ */
+
+#ifndef RC_SPSC_RING_H
+#define RC_SPSC_RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "sample.h"
+
+#define RING_SLOTS      1024            // power of two
+#define RING_SPIN       256             // polls before sleeping
+#define CACHELINE       64
+
+struct spsc_ring {
+    _Alignas(CACHELINE) atomic_uint head;   // next slot to fill
+    _Alignas(CACHELINE) atomic_uint tail;   // next slot to drain
+    _Alignas(CACHELINE) atomic_uint waiting;
+    atomic_uint wake_seq;                   // futex word
+    atomic_uint closed;
+    /* producer-side counters */
+    _Alignas(CACHELINE) atomic_uint drops;
+    atomic_uint max_depth;
+    _Alignas(CACHELINE) struct sample_rec slots[RING_SLOTS];
+};
+
+static inline void ring_futex_wait(atomic_uint *addr, unsigned val)
+{
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static inline void ring_futex_wake(atomic_uint *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/* Number of records queued right now (any thread, approximate) */
+static inline unsigned ring_depth(struct spsc_ring *r)
+{
+    return atomic_load_explicit(&r->head, memory_order_relaxed) -
+           atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+/* Producer: never blocks, drops the record when the ring is full */
+static inline int ring_push(struct spsc_ring *r, const struct sample_rec *rec)
+{
+    unsigned h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+    if (h - t >= RING_SLOTS) {
+        atomic_store_explicit(&r->drops,
+            atomic_load_explicit(&r->drops, memory_order_relaxed) + 1,
+            memory_order_relaxed);
+        return 0;
+    }
+
+    r->slots[h & (RING_SLOTS - 1)] = *rec;
+
+    unsigned depth = h + 1 - t;
+    if (depth > atomic_load_explicit(&r->max_depth, memory_order_relaxed))
+        atomic_store_explicit(&r->max_depth, depth, memory_order_relaxed);
+
+    /* seq_cst store/load pairs with the consumer's waiting handshake */
+    atomic_store(&r->head, h + 1);
+    if (atomic_load(&r->waiting)) {
+        atomic_fetch_add(&r->wake_seq, 1);
+        ring_futex_wake(&r->wake_seq);
+    }
+
+    return 1;
+}
+
+static inline int ring_try_pop(struct spsc_ring *r, struct sample_rec *rec)
+{
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    unsigned h = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    if (h == t)
+        return 0;
+
+    *rec = r->slots[t & (RING_SLOTS - 1)];
+    atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+
+    return 1;
+}
+
+/*
+ * Consumer: wait for the next record. Returns 0 once the ring is
+ * closed and drained.
+ */
+static inline int ring_pop(struct spsc_ring *r, struct sample_rec *rec)
+{
+    for (;;) {
+        for (int i = 0; i < RING_SPIN; i++)
+            if (ring_try_pop(r, rec))
+                return 1;
+
+        atomic_store(&r->waiting, 1);
+        unsigned seq = atomic_load(&r->wake_seq);
+        if (atomic_load(&r->head) ==
+            atomic_load_explicit(&r->tail, memory_order_relaxed)) {
+            if (atomic_load(&r->closed)) {
+                atomic_store(&r->waiting, 0);
+                return 0;
+            }
+            ring_futex_wait(&r->wake_seq, seq);
+        }
+        atomic_store(&r->waiting, 0);
+    }
+}
+
+/* Producer: no more records; wakes a sleeping consumer */
+static inline void ring_close(struct spsc_ring *r)
+{
+    atomic_store(&r->closed, 1);
+    atomic_fetch_add(&r->wake_seq, 1);
+    ring_futex_wake(&r->wake_seq);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * cgroup v2 cpuset steering of background work
+ *
+ * cpuset.cpus must be writable, i.e. the cpuset controller enabled in
+ * the parent's cgroup.subtree_control. Writes go through the journal,
+ * which also keeps the values to restore.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "steer.h"
+#include "journal.h"
+#include "msglog.h"
+
+struct steer_cgroup {
+    char path[JOURNAL_PATH_MAX];   // .../cpuset.cpus
+};
+
+static struct steer_cgroup cgroups[STEER_MAX_CGROUPS];
+static int n_cgroups = 0;
+static char target[STEER_CPULIST_MAX];
+
+_Static_assert(STEER_CPULIST_MAX <= JOURNAL_VALUE_MAX,
+               "steer target must fit a journal slot");
+static int applied = 0;
+
+int steer_add_cgroup(const char *dir)
+{
+    if (n_cgroups >= STEER_MAX_CGROUPS) {
+        fprintf(stderr, "steer: too many cgroups (max %d)\n",
+                STEER_MAX_CGROUPS);
+        return -1;
+    }
+
+    struct steer_cgroup *cg = &cgroups[n_cgroups];
+    if (snprintf(cg->path, sizeof(cg->path), "%s/cpuset.cpus", dir) >=
+        (int)sizeof(cg->path)) {
+        fprintf(stderr, "steer: cgroup path too long: %s\n", dir);
+        return -1;
+    }
+
+    FILE *fp = fopen(cg->path, "r");
+    if (!fp) {
+        fprintf(stderr, "steer: %s not readable "
+                "(cpuset controller not enabled?)\n", cg->path);
+        return -1;
+    }
+    fclose(fp);
+
+    n_cgroups++;
+    return 0;
+}
+
+int steer_count(void)
+{
+    return n_cgroups;
+}
+
+void steer_set_cpus(const char *cpulist)
+{
+    steer_restore();
+    if (snprintf(target, sizeof(target), "%s", cpulist ? cpulist : "") >=
+        (int)sizeof(target)) {
+        fprintf(stderr, "steer: cpu list too long, not steering\n");
+        target[0] = '\0';
+    }
+}
+
+void steer_apply(void)
+{
+    if (n_cgroups == 0 || !*target || applied)
+        return;
+
+    for (int i = 0; i < n_cgroups; i++)
+        journal_write(cgroups[i].path, target);
+
+    applied = 1;
+    msglog_printf("Background cgroup(s) steered to cpus %s\n", target);
+}
+
+void steer_restore(void)
+{
+    if (!applied)
+        return;
+
+    for (int i = 0; i < n_cgroups; i++)
+        journal_restore(cgroups[i].path);
+
+    applied = 0;
+}
+
+int steer_active(void)
+{
+    return applied;
+}
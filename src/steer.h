@@ -0,0 +1,34 @@
+/*
+ * cgroup v2 cpuset steering of background work
+ *
+ * On hybrid parts, designated background cgroups are confined to the
+ * efficient cores while mitigation is on, so the performance cores'
+ * heat budget goes to the foreground.
+ */
+
+#ifndef RC_STEER_H
+#define RC_STEER_H
+
+#define STEER_MAX_CGROUPS   16
+#define STEER_CPULIST_MAX   256     // a journal value, JOURNAL_VALUE_MAX
+
+/* Register a cgroup directory; returns 0 on success, -1 if unusable */
+int steer_add_cgroup(const char *dir);
+
+int steer_count(void);
+
+/*
+ * cpu list the cgroups are confined to; "" disables steering, as does
+ * a list longer than STEER_CPULIST_MAX - 1
+ */
+void steer_set_cpus(const char *cpulist);
+
+/* Confine every cgroup (journaled); no-op if already applied */
+void steer_apply(void);
+
+/* Put the original cpuset.cpus back */
+void steer_restore(void);
+
+int steer_active(void);
+
+#endif
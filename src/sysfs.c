@@ -0,0 +1,230 @@
+/*
+ * sysfs sensors and cpufreq policy
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "sysfs.h"
+#include "journal.h"
+
+#define POLICY_FMT \
+    "%s/sys/devices/system/cpu/cpu%d/cpufreq/%s"
+#define POLICY_MAX_FMT \
+    "%s/sys/devices/system/cpu/cpu%d/cpufreq/scaling_max_freq"
+
+void sysfs_init(struct sysfs_ctx *s, const char *root, int zone, int cpu)
+{
+    if (!root)
+        root = "";
+
+    snprintf(s->temp_path, sizeof(s->temp_path),
+             "%s/sys/class/thermal/thermal_zone%d/temp", root, zone);
+    snprintf(s->freq_cur_path, sizeof(s->freq_cur_path),
+             "%s/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq",
+             root, cpu);
+    snprintf(s->freq_max_path, sizeof(s->freq_max_path), POLICY_MAX_FMT,
+             root, cpu);
+    snprintf(s->root, sizeof(s->root), "%s", root);
+    s->policy_cpu[0] = (int16_t)cpu;
+    s->n_policies = 1;
+    s->capped = 0;
+}
+
+int sysfs_add_policy(struct sysfs_ctx *s, int cpu)
+{
+    for (int i = 0; i < s->n_policies; i++)
+        if (s->policy_cpu[i] == cpu)
+            return 0;
+    if (s->n_policies >= SYSFS_MAX_POLICIES)
+        return -1;
+
+    s->policy_cpu[s->n_policies++] = (int16_t)cpu;
+    return 0;
+}
+
+static void policy_max_path(const struct sysfs_ctx *s, int i, char *buf,
+                            size_t len)
+{
+    if (i == 0)
+        snprintf(buf, len, "%s", s->freq_max_path);
+    else
+        snprintf(buf, len, POLICY_MAX_FMT, s->root, s->policy_cpu[i]);
+}
+
+double sysfs_read_temperature(struct sysfs_ctx *s)
+{
+    FILE *fp = fopen(s->temp_path, "r");
+    if (!fp) return -1.0;
+
+    int temp_milli;
+    int ok = fscanf(fp, "%d", &temp_milli) == 1;
+    fclose(fp);
+
+    return ok ? temp_milli / 1000.0 : -1.0;
+}
+
+double sysfs_read_frequency(struct sysfs_ctx *s)
+{
+    FILE *fp = fopen(s->freq_cur_path, "r");
+    if (!fp) return -1.0;
+
+    int freq_khz;
+    int ok = fscanf(fp, "%d", &freq_khz) == 1;
+    fclose(fp);
+
+    return ok ? freq_khz / 1e6 : -1.0;
+}
+
+int sysfs_read_max_frequency(struct sysfs_ctx *s)
+{
+    FILE *fp = fopen(s->freq_max_path, "r");
+    if (!fp) return -1;
+
+    int freq;
+    int ok = fscanf(fp, "%d", &freq) == 1;
+    fclose(fp);
+
+    return ok && freq > 0 ? freq : -1;
+}
+
+static int read_khz(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return 0;
+
+    int khz;
+    int ok = fscanf(fp, "%d", &khz) == 1;
+    fclose(fp);
+
+    return ok && khz > 0 ? khz : 0;
+}
+
+static int policy_khz(const struct sysfs_ctx *s, int i, const char *attr)
+{
+    char path[256];
+    snprintf(path, sizeof(path), POLICY_FMT, s->root, s->policy_cpu[i],
+             attr);
+    return read_khz(path);
+}
+
+/* Every policy's limits and uncapped maximum, as the cap starts */
+static void read_originals(struct sysfs_ctx *s)
+{
+    char path[256];
+
+    for (int i = 0; i < s->n_policies; i++) {
+        policy_max_path(s, i, path, sizeof(path));
+        s->min_khz[i] = policy_khz(s, i, "cpuinfo_min_freq");
+        s->max_khz[i] = policy_khz(s, i, "cpuinfo_max_freq");
+        s->orig_khz[i] = read_khz(path);
+        if (!s->orig_khz[i])
+            s->orig_khz[i] = s->max_khz[i];
+    }
+    s->capped = 1;
+}
+
+void sysfs_write_max_frequency(struct sysfs_ctx *s, int freq)
+{
+    char buf[16], path[256];
+
+    if (!s->capped)
+        read_originals(s);
+    double share = s->orig_khz[0] > 0 ? (double)freq / s->orig_khz[0] : 0;
+
+    for (int i = 0; i < s->n_policies; i++) {
+        int khz = freq;
+
+        if (share > 0 && s->orig_khz[i] > 0)
+            khz = (int)(s->orig_khz[i] * share + 0.5);
+        if (s->max_khz[i] && khz > s->max_khz[i])
+            khz = s->max_khz[i];
+        if (s->min_khz[i] && khz < s->min_khz[i])
+            khz = s->min_khz[i];
+
+        snprintf(buf, sizeof(buf), "%d", khz);
+        policy_max_path(s, i, path, sizeof(path));
+        journal_write(path, buf);
+    }
+}
+
+/* Without a journal entry, the original read at cap time is written */
+int sysfs_restore_max_frequency(struct sysfs_ctx *s)
+{
+    char path[256];
+    int rc = -1;
+
+    for (int i = 0; i < s->n_policies; i++) {
+        policy_max_path(s, i, path, sizeof(path));
+        if (journal_restore(path) == 0) {
+            rc = 0;
+        }
+        else if (s->capped && s->orig_khz[i] > 0) {
+            FILE *fp = fopen(path, "w");
+            if (fp) {
+                fprintf(fp, "%d", s->orig_khz[i]);
+                if (fclose(fp) == 0)
+                    rc = 0;
+            }
+        }
+    }
+    s->capped = 0;
+    return rc;
+}
+
+/* Placeholder CPU utilization (safe default) */
+double estimate_utilization(void)
+{
+    return 0.7;
+}
+
+/* platform_ops adapters */
+static double temperature(void *ctx)
+{
+    return sysfs_read_temperature(ctx);
+}
+
+static double frequency(void *ctx)
+{
+    return sysfs_read_frequency(ctx);
+}
+
+static double utilization(void *ctx)
+{
+    (void)ctx;
+    return estimate_utilization();
+}
+
+static int max_frequency(void *ctx)
+{
+    return sysfs_read_max_frequency(ctx);
+}
+
+static void set_max_frequency(void *ctx, int khz)
+{
+    sysfs_write_max_frequency(ctx, khz);
+}
+
+static int restore_max_frequency(void *ctx)
+{
+    return sysfs_restore_max_frequency(ctx);
+}
+
+static double monotonic_s(void *ctx)
+{
+    struct timespec ts;
+
+    (void)ctx;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+const struct platform_ops sysfs_platform = {
+    .read_temperature      = temperature,
+    .read_frequency        = frequency,
+    .read_utilization      = utilization,
+    .read_max_frequency    = max_frequency,
+    .write_max_frequency   = set_max_frequency,
+    .restore_max_frequency = restore_max_frequency,
+    .now                   = monotonic_s,
+};
@@ -0,0 +1,69 @@
+/*
+ * sysfs sensors and cpufreq policy: the real platform_ops
+ *
+ * One sysfs_ctx names one thermal zone and the cpufreq policies it
+ * caps (a package's, say); pass it as the platform context. The first
+ * policy stands for the rest when frequencies are read, and a cap is
+ * given in its terms: each policy gets the same share of its own
+ * original maximum, within its own cpuinfo_min/max_freq, so policies
+ * with different ceilings (hybrid clusters, turbo bins) keep their
+ * proportions.
+ */
+
+#ifndef RC_SYSFS_H
+#define RC_SYSFS_H
+
+#include <stdint.h>
+
+#include "platform.h"
+
+#define TEMP_PATH     "/sys/class/thermal/thermal_zone0/temp"
+#define FREQ_CUR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq"
+#define FREQ_MAX_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_max_freq"
+
+#define SYSFS_MAX_POLICIES  256
+
+struct sysfs_ctx {
+    char temp_path[256];
+    char freq_cur_path[256];
+    char freq_max_path[256];        // first policy
+    char root[128];
+    int n_policies;
+    int16_t policy_cpu[SYSFS_MAX_POLICIES];
+    int capped;
+    int orig_khz[SYSFS_MAX_POLICIES];   // scaling_max_freq before the cap
+    int min_khz[SYSFS_MAX_POLICIES];    // cpuinfo_min_freq, 0 unknown
+    int max_khz[SYSFS_MAX_POLICIES];    // cpuinfo_max_freq, 0 unknown
+};
+
+/* Zone 0 and cpu0's policy under the real /sys */
+#define SYSFS_CTX_INIT \
+    { TEMP_PATH, FREQ_CUR_PATH, FREQ_MAX_PATH, "", 1, { 0 } }
+
+extern const struct platform_ops sysfs_platform;
+
+/*
+ * Point `s` at thermal_zone<zone> and the policy of cpu<cpu>, every
+ * path prefixed with `root` (e.g. a fake tree for benchmarks); NULL or
+ * "" is the real /sys.
+ */
+void sysfs_init(struct sysfs_ctx *s, const char *root, int zone, int cpu);
+
+/* Also cap the policy of cpu<cpu>; -1 when the table is full */
+int sysfs_add_policy(struct sysfs_ctx *s, int cpu);
+
+double sysfs_read_temperature(struct sysfs_ctx *s);   // °C, -1 on failure
+double sysfs_read_frequency(struct sysfs_ctx *s);     // GHz, -1 on failure
+int sysfs_read_max_frequency(struct sysfs_ctx *s);    // kHz, -1 on failure
+/*
+ * Cap every policy at the share `freq` is of the first policy's
+ * original (journaled); the originals are read on the first write
+ * after init or a restore
+ */
+void sysfs_write_max_frequency(struct sysfs_ctx *s, int freq);
+
+/* Put every policy's original back; 0, or -1 if none was capped */
+int sysfs_restore_max_frequency(struct sysfs_ctx *s);
+double estimate_utilization(void);
+
+#endif
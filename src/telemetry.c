@@ -0,0 +1,68 @@
+/*
+ * Shared-memory telemetry: writer side (daemon)
+ *
+ * Only the actuator thread publishes, so the seqlock has a single
+ * writer and needs no further synchronisation.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "telemetry.h"
+#include "seqlock.h"
+
+static struct rc_telem_page *page = NULL;
+static char page_path[256];
+
+int telemetry_open(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || ftruncate(fd, sizeof(*page)) < 0) {
+        fprintf(stderr, "telemetry: %s: %s\n", path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+
+    void *p = mmap(NULL, sizeof(*page), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    page = p;
+    memset(page, 0, sizeof(*page));
+    page->version = RC_TELEM_VERSION;
+    page->size = sizeof(*page);
+    page->writer_pid = (uint32_t)getpid();
+    /* magic last: readers reject the page until the header is complete */
+    atomic_thread_fence(memory_order_release);
+    page->magic = RC_TELEM_MAGIC;
+
+    snprintf(page_path, sizeof(page_path), "%s", path);
+    return 0;
+}
+
+void telemetry_publish(const struct rc_telem_data *d)
+{
+    if (!page)
+        return;
+
+    seq_write_begin(&page->seq);
+    memcpy(&page->data, d, sizeof(*d));
+    seq_write_end(&page->seq);
+}
+
+void telemetry_close(void)
+{
+    if (!page)
+        return;
+
+    munmap(page, sizeof(*page));
+    page = NULL;
+    unlink(page_path);
+}
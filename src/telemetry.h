@@ -0,0 +1,18 @@
+/*
+ * Shared-memory telemetry: writer side (daemon)
+ */
+
+#ifndef RC_TELEMETRY_WRITER_H
+#define RC_TELEMETRY_WRITER_H
+
+#include "rc_telemetry.h"
+
+/* Create/map the telemetry file; returns 0 or -1 (telemetry disabled) */
+int telemetry_open(const char *path);
+
+/* Publish a snapshot; no-op when telemetry is disabled */
+void telemetry_publish(const struct rc_telem_data *d);
+
+void telemetry_close(void);
+
+#endif
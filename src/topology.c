@@ -0,0 +1,300 @@
+/*
+ * CPU package topology
+ *
+ * Thermal zones carry no package id, so they are matched by type:
+ * x86_pkg_temp zones are registered one per package in package order,
+ * and zones named after a cpu ("cpu4-thermal") belong to that cpu's
+ * package. Anything else (acpitz, board sensors) is left unassigned.
+ * RAPL package domains name their package ("package-1").
+ *
+ * Core types come from the hybrid PMUs Intel registers (cpu_core,
+ * cpu_atom) when present, else from cpu_capacity: with a spread wider
+ * than TOPO_HYBRID_SPREAD the cpus above the midpoint are performance
+ * cores. cpuinfo_max_freq is not a signal; favoured cores (Turbo Boost
+ * Max 3.0, amd-pstate preferred cores) spread it on uniform parts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "topology.h"
+
+#define CPU_DIR     "/sys/devices/system/cpu"
+#define CPU_ATTR(a) CPU_DIR "/cpu%d/" a
+#define THERMAL_DIR "/sys/class/thermal"
+#define RAPL_DIR    "/sys/class/powercap"
+#define PMU_DIR     "/sys/devices"
+
+static int read_str(const char *root, char *buf, size_t len,
+                    const char *fmt, int n)
+{
+    char rel[160], path[320];
+    snprintf(rel, sizeof(rel), fmt, n);
+    snprintf(path, sizeof(path), "%s%s", root, rel);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+
+    int ok = fgets(buf, (int)len, fp) != NULL;
+    fclose(fp);
+    if (!ok)
+        return -1;
+
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+/* Integer at `fmt` % n; `fallback` if missing or unparsable */
+static int read_int(const char *root, const char *fmt, int n, int fallback)
+{
+    char buf[32];
+    char *end;
+
+    if (read_str(root, buf, sizeof(buf), fmt, n) < 0)
+        return fallback;
+
+    long v = strtol(buf, &end, 10);
+    return end == buf ? fallback : (int)v;
+}
+
+static int exists(const char *root, const char *fmt, int n)
+{
+    char rel[160], path[320];
+    struct stat st;
+
+    snprintf(rel, sizeof(rel), fmt, n);
+    snprintf(path, sizeof(path), "%s%s", root, rel);
+    return stat(path, &st) == 0;
+}
+
+static int dense_pkg(const struct topology *t, int package_id)
+{
+    for (int k = 0; k < t->n_packages; k++)
+        if (t->package_id[k] == package_id)
+            return k;
+    return -1;
+}
+
+static int cmp_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/* =======================
+   CPUs and policies
+   ======================= */
+static void probe_cpus(struct topology *t, const char *root)
+{
+    int phys[TOPO_MAX_CPUS];
+
+    for (int cpu = 0; cpu < TOPO_MAX_CPUS; cpu++) {
+        if (!exists(root, CPU_DIR "/cpu%d", cpu))
+            break;
+        t->n_cpus = cpu + 1;
+        t->pkg[cpu] = t->die[cpu] = t->cluster[cpu] = t->core[cpu] = -1;
+        t->policy[cpu] = -1;
+        phys[cpu] = -1;
+
+        if (read_int(root, CPU_ATTR("online"), cpu, 1) == 0)
+            continue;
+
+        phys[cpu] = read_int(root, CPU_ATTR("topology/physical_package_id"),
+                             cpu, -1);
+        t->die[cpu] = read_int(root, CPU_ATTR("topology/die_id"), cpu, -1);
+        t->cluster[cpu] = read_int(root, CPU_ATTR("topology/cluster_id"),
+                                   cpu, -1);
+        t->core[cpu] = read_int(root, CPU_ATTR("topology/core_id"), cpu, -1);
+
+        if (phys[cpu] >= 0 && dense_pkg(t, phys[cpu]) < 0 &&
+            t->n_packages < TOPO_MAX_PACKAGES)
+            t->package_id[t->n_packages++] = phys[cpu];
+
+        /* related_cpus lists the policy's cpus, lowest first */
+        if (exists(root, CPU_ATTR("cpufreq/scaling_max_freq"), cpu))
+            t->policy[cpu] = read_int(root, CPU_ATTR("cpufreq/related_cpus"),
+                                      cpu, cpu);
+    }
+
+    qsort(t->package_id, t->n_packages, sizeof(int), cmp_int);
+
+    for (int cpu = 0; cpu < t->n_cpus; cpu++) {
+        if (phys[cpu] < 0)
+            continue;
+        int k = dense_pkg(t, phys[cpu]);
+        t->pkg[cpu] = k;
+        if (k < 0)
+            continue;
+        t->pkg_cpus[k]++;
+        if (t->policy[cpu] == cpu)
+            t->pkg_policies[k]++;
+    }
+}
+
+/* =======================
+   Core types
+   ======================= */
+
+/* Mark every cpu in a kernel cpu list ("0-7,16") as `type` */
+static int mark_list(struct topology *t, const char *list, int type)
+{
+    int n = 0;
+    const char *p = list;
+
+    while (*p) {
+        char *end;
+        long a = strtol(p, &end, 10), b = a;
+        if (end == p)
+            break;
+        if (*end == '-')
+            b = strtol(end + 1, &end, 10);
+        for (long c = a; c <= b && c < t->n_cpus; c++, n++)
+            t->core_type[c] = (uint8_t)type;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return n;
+}
+
+static void probe_core_types(struct topology *t, const char *root)
+{
+    char list[512];
+    int score[TOPO_MAX_CPUS];
+    int lo = 0, hi = 0;
+
+    if (read_str(root, list, sizeof(list), PMU_DIR "/cpu_atom/cpus", 0) == 0 &&
+        mark_list(t, list, TOPO_CORE_EFF) > 0 &&
+        read_str(root, list, sizeof(list), PMU_DIR "/cpu_core/cpus", 0) == 0 &&
+        mark_list(t, list, TOPO_CORE_PERF) > 0) {
+        t->hybrid = 1;
+        t->hybrid_by = "cpu_core/cpu_atom pmu";
+        return;
+    }
+    memset(t->core_type, TOPO_CORE_UNIFORM, sizeof(t->core_type));
+
+    for (int cpu = 0; cpu < t->n_cpus; cpu++) {
+        score[cpu] = read_int(root, CPU_ATTR("cpu_capacity"), cpu, 0);
+        if (t->pkg[cpu] < 0 || score[cpu] <= 0)
+            continue;
+        if (!lo || score[cpu] < lo) lo = score[cpu];
+        if (score[cpu] > hi) hi = score[cpu];
+    }
+
+    if (!lo || hi <= lo * (1.0 + TOPO_HYBRID_SPREAD))
+        return;
+
+    for (int cpu = 0; cpu < t->n_cpus; cpu++)
+        if (t->pkg[cpu] >= 0 && score[cpu] > 0)
+            t->core_type[cpu] = 2 * score[cpu] >= lo + hi ? TOPO_CORE_PERF :
+                                                            TOPO_CORE_EFF;
+    t->hybrid = 1;
+    t->hybrid_by = "cpu_capacity";
+}
+
+/* =======================
+   Thermal zones and RAPL
+   ======================= */
+static void probe_zones(struct topology *t, const char *root)
+{
+    int pkg_temp = 0;
+
+    for (int z = 0; z < TOPO_MAX_ZONES; z++) {
+        char *type = t->zone_type[z];
+        int cpu;
+
+        if (read_str(root, type, sizeof(t->zone_type[z]),
+                     THERMAL_DIR "/thermal_zone%d/type", z) < 0)
+            break;
+        t->n_zones = z + 1;
+        t->zone_pkg[z] = -1;
+
+        if (strcmp(type, "x86_pkg_temp") == 0) {
+            if (pkg_temp < t->n_packages)
+                t->zone_pkg[z] = pkg_temp;
+            pkg_temp++;
+        }
+        else if (sscanf(type, "cpu%d", &cpu) == 1) {
+            t->zone_pkg[z] = topology_pkg(t, cpu);
+        }
+
+        int k = t->zone_pkg[z];
+        if (k >= 0 && t->pkg_zone[k] < 0)
+            t->pkg_zone[k] = z;
+    }
+}
+
+static void probe_rapl(struct topology *t, const char *root)
+{
+    for (int d = 0; d < 64; d++) {
+        char name[32];
+        int id;
+
+        if (read_str(root, name, sizeof(name),
+                     RAPL_DIR "/intel-rapl:%d/name", d) < 0)
+            break;
+        if (sscanf(name, "package-%d", &id) != 1)
+            continue;
+
+        int k = dense_pkg(t, id);
+        if (k >= 0 && t->pkg_rapl[k] < 0)
+            t->pkg_rapl[k] = d;
+    }
+}
+
+int topology_probe(struct topology *t, const char *root)
+{
+    memset(t, 0, sizeof(*t));
+    for (int k = 0; k < TOPO_MAX_PACKAGES; k++)
+        t->pkg_zone[k] = t->pkg_rapl[k] = -1;
+
+    if (!root)
+        root = "";
+    probe_cpus(t, root);
+    probe_core_types(t, root);
+    probe_zones(t, root);
+    probe_rapl(t, root);
+
+    return t->n_packages > 0 ? 0 : -1;
+}
+
+int topology_policies(const struct topology *t, int pkg, int *cpus, int max)
+{
+    return topology_policies_of(t, pkg, TOPO_CORE_UNIFORM, cpus, max);
+}
+
+int topology_policies_of(const struct topology *t, int pkg, int type,
+                         int *cpus, int max)
+{
+    int n = 0;
+
+    for (int cpu = 0; cpu < t->n_cpus && n < max; cpu++)
+        if (t->pkg[cpu] == pkg && t->policy[cpu] == cpu &&
+            (type == TOPO_CORE_UNIFORM || t->core_type[cpu] == type))
+            cpus[n++] = cpu;
+    return n;
+}
+
+int topology_cpulist(const struct topology *t, int type, char *buf,
+                     size_t len)
+{
+    int off = 0, n = 0;
+
+    buf[0] = '\0';
+    for (int cpu = 0; cpu < t->n_cpus; cpu++) {
+        if (t->pkg[cpu] < 0 || t->core_type[cpu] != type)
+            continue;
+
+        int last = cpu;
+        while (last + 1 < t->n_cpus && t->pkg[last + 1] >= 0 &&
+               t->core_type[last + 1] == type)
+            last++;
+
+        off += snprintf(buf + off, off < (int)len ? len - off : 0,
+                        last > cpu ? "%s%d-%d" : "%s%d",
+                        n ? "," : "", cpu, last);
+        n += last - cpu + 1;
+        cpu = last;
+    }
+    return off < (int)len ? n : -1;
+}
@@ -0,0 +1,77 @@
+/*
+ * CPU package topology
+ *
+ * A snapshot of /sys/devices/system/cpu/cpu<N>/topology, the cpufreq
+ * policies, thermal zones and RAPL domains, resolved to a dense
+ * package index, and on hybrid parts the type of every core. Built
+ * once at startup; every lookup afterwards is an array index.
+ */
+
+#ifndef RC_TOPOLOGY_H
+#define RC_TOPOLOGY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TOPO_MAX_CPUS       1024
+#define TOPO_MAX_PACKAGES   8
+#define TOPO_MAX_ZONES      64
+
+/* core_type */
+#define TOPO_CORE_UNIFORM   0       // not a hybrid part, or unknown
+#define TOPO_CORE_PERF      1       // P-core, big
+#define TOPO_CORE_EFF       2       // E-core, LITTLE
+
+/* cpu_capacity values closer than this (relative) are one core type */
+#define TOPO_HYBRID_SPREAD  0.10
+
+struct topology {
+    int n_cpus;                         // cpu ids probed: 0..n_cpus-1
+    int16_t pkg[TOPO_MAX_CPUS];         // dense package, -1 offline/absent
+    int16_t die[TOPO_MAX_CPUS];         // -1 where the kernel has none
+    int16_t cluster[TOPO_MAX_CPUS];
+    int16_t core[TOPO_MAX_CPUS];
+    int16_t policy[TOPO_MAX_CPUS];      // first cpu of its policy, -1 none
+    uint8_t core_type[TOPO_MAX_CPUS];   // TOPO_CORE_*
+    int hybrid;                         // two core types were found
+    const char *hybrid_by;              // the sysfs signal that said so
+
+    int n_packages;
+    int package_id[TOPO_MAX_PACKAGES];  // physical_package_id, ascending
+    int pkg_cpus[TOPO_MAX_PACKAGES];
+    int pkg_policies[TOPO_MAX_PACKAGES];
+    int pkg_zone[TOPO_MAX_PACKAGES];    // thermal_zone<N>, -1 none
+    int pkg_rapl[TOPO_MAX_PACKAGES];    // intel-rapl:<N>, -1 none
+
+    int n_zones;
+    int16_t zone_pkg[TOPO_MAX_ZONES];   // -1: not tied to one package
+    char zone_type[TOPO_MAX_ZONES][20];
+};
+
+/*
+ * Probe the tree under `root` (NULL or "" is the real /sys). Returns
+ * 0, or -1 when no cpu topology is visible at all.
+ */
+int topology_probe(struct topology *t, const char *root);
+
+/* First cpus of the policies on package `pkg`; returns how many */
+int topology_policies(const struct topology *t, int pkg, int *cpus, int max);
+
+/*
+ * Like topology_policies(), restricted to policies whose cpus are of
+ * `type`; TOPO_CORE_UNIFORM matches every policy.
+ */
+int topology_policies_of(const struct topology *t, int pkg, int type,
+                         int *cpus, int max);
+
+/* Kernel cpu list ("4-7,12") of the online cpus of `type` */
+int topology_cpulist(const struct topology *t, int type, char *buf,
+                     size_t len);
+
+/* Dense package of `cpu`, -1 if unknown */
+static inline int topology_pkg(const struct topology *t, int cpu)
+{
+    return cpu >= 0 && cpu < t->n_cpus ? t->pkg[cpu] : -1;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * Kernel trip points of a thermal zone
+ *
+ * Zones list their trips densely from 0; a zone may have several
+ * passive trips (one per cooling stage), and the lowest is the one
+ * that matters. Temperatures are in millidegrees; drivers report 0 or
+ * absurd values for trips they do not use, so those are skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trips.h"
+
+#define TRIPS_MAX       32
+#define TRIP_MIN_MC     1               // m°C
+#define TRIP_MAX_MC     200000
+#define TRIP_MIN_GAP    1.0             // °C kept between t_high and t_critical
+
+static int read_line(const char *root, int zone, int trip, const char *attr,
+                     char *buf, int len)
+{
+    char path[320];
+    snprintf(path, sizeof(path),
+             "%s/sys/class/thermal/thermal_zone%d/trip_point_%d_%s",
+             root, zone, trip, attr);
+
+    FILE *fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+
+    int ok = fgets(buf, len, fp) != NULL;
+    fclose(fp);
+    if (!ok)
+        return -1;
+
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+static void lowest(double *slot, double c)
+{
+    if (*slot <= 0.0 || c < *slot)
+        *slot = c;
+}
+
+int trips_read(const char *root, int zone, struct trips *t)
+{
+    memset(t, 0, sizeof(*t));
+    if (!root)
+        root = "";
+
+    for (int i = 0; i < TRIPS_MAX; i++) {
+        char type[32], temp[32];
+        char *end;
+
+        if (read_line(root, zone, i, "type", type, sizeof(type)) < 0)
+            break;
+        if (read_line(root, zone, i, "temp", temp, sizeof(temp)) < 0)
+            continue;
+
+        long mc = strtol(temp, &end, 10);
+        if (end == temp || mc < TRIP_MIN_MC || mc > TRIP_MAX_MC)
+            continue;
+
+        if (strcmp(type, "passive") == 0)
+            lowest(&t->passive, mc / 1000.0);
+        else if (strcmp(type, "critical") == 0)
+            lowest(&t->critical, mc / 1000.0);
+    }
+
+    return (t->passive > 0.0) + (t->critical > 0.0);
+}
+
+int trips_thresholds(const struct rc_params *base, const struct trips *t,
+                     struct rc_params *out)
+{
+    *out = *base;
+    if (!base->trip_auto || (t->passive <= 0.0 && t->critical <= 0.0))
+        return 0;
+
+    double band = base->t_high - base->t_low;
+    double gap = base->t_critical - base->t_high;
+    double high, critical;
+
+    if (t->passive > 0.0) {
+        high = t->passive - base->trip_high_offset;
+        critical = t->critical > 0.0 ?
+                       t->critical - base->trip_critical_offset :
+                       high + gap;
+    }
+    else {
+        critical = t->critical - base->trip_critical_offset;
+        high = critical - gap;
+    }
+
+    /*
+     * Trips closer together than the offsets (passive 95, critical 100
+     * with offsets 5 and 10): t_critical goes just above t_high, and if
+     * that crosses the critical trip itself, both move below it.
+     */
+    int clamped = 0;
+    if (critical < high + TRIP_MIN_GAP) {
+        critical = high + TRIP_MIN_GAP;
+        if (t->critical > 0.0 && critical > t->critical - TRIP_MIN_GAP) {
+            critical = t->critical - TRIP_MIN_GAP;
+            high = critical - TRIP_MIN_GAP;
+        }
+        clamped = 1;
+    }
+
+    if (high - band <= base->t_ambient)
+        return 0;
+
+    out->t_high = high;
+    out->t_low = high - band;
+    out->t_critical = critical;
+    return clamped ? 2 : 1;
+}
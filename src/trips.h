@@ -0,0 +1,40 @@
+/*
+ * Kernel trip points of a thermal zone
+ *
+ * thermal_zone<N>/trip_point_<i>_{type,temp} say where the kernel's
+ * own passive cooling starts and where it shuts the machine down. The
+ * controller's thresholds can be placed relative to them instead of at
+ * fixed temperatures, so a part rated for 100 °C is not throttled as
+ * if it were rated for 80.
+ */
+
+#ifndef RC_TRIPS_H
+#define RC_TRIPS_H
+
+#include "params.h"
+
+struct trips {
+    double passive;         // °C, lowest passive trip, 0 if none
+    double critical;        // °C, lowest critical trip, 0 if none
+};
+
+/*
+ * Read the trips of thermal_zone<zone> under `root` (NULL or "" is
+ * the real /sys). Returns how many of the two were found.
+ */
+int trips_read(const char *root, int zone, struct trips *t);
+
+/*
+ * `base` with t_high, t_low and t_critical placed trip_high_offset
+ * below the passive trip and trip_critical_offset below the critical
+ * one, keeping base's hysteresis band. A missing trip keeps base's
+ * spacing from the other. When the offsets would put t_critical at or
+ * below t_high, it is raised to just above t_high, staying below the
+ * critical trip. Returns 1 if the thresholds were derived as given, 2
+ * if they were clamped that way, 0 if `out` is a plain copy
+ * (trip_auto off, no trips, or t_low would fall to ambient).
+ */
+int trips_thresholds(const struct rc_params *base, const struct trips *t,
+                     struct rc_params *out);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * cgroup v2 cpu.uclamp.max actuator
+ *
+ * cpu.uclamp.max accepts either "max" or a percentage with two
+ * decimals ("42.50"). The clamp only takes effect with a
+ * utilization-driven governor such as schedutil. Writes go through
+ * the journal, which also keeps the values to restore.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "uclamp.h"
+#include "journal.h"
+#include "msglog.h"
+
+struct uclamp_cgroup {
+    char path[256];        // .../cpu.uclamp.max
+};
+
+static struct uclamp_cgroup cgroups[UCLAMP_MAX_CGROUPS];
+static int n_cgroups = 0;
+static double applied_pct = 100.0;
+
+static int readable(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) return 0;
+
+    char buf[16];
+    int ok = fgets(buf, sizeof(buf), fp) != NULL;
+    fclose(fp);
+
+    return ok;
+}
+
+int uclamp_add_cgroup(const char *dir)
+{
+    if (n_cgroups >= UCLAMP_MAX_CGROUPS) {
+        fprintf(stderr, "uclamp: too many cgroups (max %d)\n",
+                UCLAMP_MAX_CGROUPS);
+        return -1;
+    }
+
+    struct uclamp_cgroup *cg = &cgroups[n_cgroups];
+    snprintf(cg->path, sizeof(cg->path), "%s/cpu.uclamp.max", dir);
+
+    if (!readable(cg->path)) {
+        fprintf(stderr, "uclamp: %s not readable "
+                "(cpu controller not enabled?)\n", cg->path);
+        return -1;
+    }
+
+    n_cgroups++;
+    return 0;
+}
+
+int uclamp_count(void)
+{
+    return n_cgroups;
+}
+
+void uclamp_apply(double overshoot)
+{
+    if (n_cgroups == 0)
+        return;
+
+    double pct = 100.0 - UCLAMP_GAIN * (overshoot > 0 ? overshoot : 0);
+    if (pct < UCLAMP_MIN_PCT)
+        pct = UCLAMP_MIN_PCT;
+
+    /* Quantize so small wobbles in T_pred don't rewrite cgroup files */
+    pct = floor(pct / UCLAMP_STEP_PCT) * UCLAMP_STEP_PCT;
+    if (pct >= 100.0) {
+        uclamp_restore();
+        return;
+    }
+    if (pct == applied_pct)
+        return;
+
+    char val[16];
+    snprintf(val, sizeof(val), "%.2f", pct);
+
+    for (int i = 0; i < n_cgroups; i++)
+        journal_write(cgroups[i].path, val);
+
+    applied_pct = pct;
+    msglog_printf("uclamp.max set to %s on %d cgroup(s)\n", val, n_cgroups);
+}
+
+double uclamp_current_pct(void)
+{
+    return applied_pct;
+}
+
+void uclamp_restore(void)
+{
+    if (n_cgroups == 0 || applied_pct >= 100.0)
+        return;
+
+    for (int i = 0; i < n_cgroups; i++)
+        journal_restore(cgroups[i].path);
+
+    applied_pct = 100.0;
+}
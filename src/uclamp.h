@@ -0,0 +1,33 @@
+/*
+ * cgroup v2 cpu.uclamp.max actuator
+ *
+ * Clamps the utilization that schedutil sees for a set of designated
+ * cgroups, so only the tasks inside them run at lower frequency.
+ */
+
+#ifndef RC_UCLAMP_H
+#define RC_UCLAMP_H
+
+#define UCLAMP_MAX_CGROUPS  16
+
+/* Clamp policy: percent removed per °C of predicted overshoot */
+#define UCLAMP_GAIN         8.0
+#define UCLAMP_MIN_PCT      20.0
+#define UCLAMP_STEP_PCT     5.0
+
+/* Register a cgroup directory; returns 0 on success, -1 if unusable */
+int uclamp_add_cgroup(const char *dir);
+
+/* Number of registered cgroups */
+int uclamp_count(void);
+
+/* Set uclamp.max on every cgroup according to the overshoot (°C) */
+void uclamp_apply(double overshoot);
+
+/* Clamp currently applied, 100 when unclamped */
+double uclamp_current_pct(void);
+
+/* Put back the values found before the first clamp */
+void uclamp_restore(void);
+
+#endif
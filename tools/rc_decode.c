@@ -0,0 +1,106 @@
+/*
+ * rc_decode — print an rc_sched binary sample log
+ *
+ * Usage: rc_decode [--csv] [--tail N] [LOG]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "rc_record.h"
+#include "recorder.h"
+
+static int csv = 0;
+
+static void print_sample(const struct rec_sample *s)
+{
+    time_t secs = (time_t)(s->wall_ns / 1000000000LL);
+    struct tm tm;
+    char when[32];
+    localtime_r(&secs, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+    int ms = (int)(s->wall_ns / 1000000 % 1000);
+
+    if (csv) {
+        printf("%s.%03d,%d,%.2f,%.2f,%.3f,%.2f,%.0f,%d,%d,%d,%d\n",
+               when, ms, s->valid, s->temp_c, s->pred_c, s->freq_ghz,
+               s->power_w, s->util * 100, s->mitigation_level,
+               s->idle_pct, s->cap_khz, s->uclamp_pct);
+        return;
+    }
+
+    if (!s->valid) {
+        printf("%s.%03d sensor read failed\n", when, ms);
+        return;
+    }
+
+    printf("%s.%03d T=%.2f°C T_pred=%.2f°C f=%.3f GHz P=%.2f W util=%.0f%%",
+           when, ms, s->temp_c, s->pred_c, s->freq_ghz, s->power_w,
+           s->util * 100);
+    if (s->mitigation_level)
+        printf(" mitigation=%d cap=%d kHz uclamp=%d%% idle=%d%%",
+               s->mitigation_level, s->cap_khz, s->uclamp_pct, s->idle_pct);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "csv",  no_argument,       NULL, 'c' },
+        { "tail", required_argument, NULL, 'n' },
+        { NULL, 0, NULL, 0 }
+    };
+    unsigned long long tail = 0;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "cn:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'c': csv = 1; break;
+        case 'n': tail = strtoull(optarg, NULL, 10); break;
+        default:
+            fprintf(stderr, "Usage: %s [--csv] [--tail N] [LOG]\n", argv[0]);
+            return 1;
+        }
+    }
+    const char *path = optind < argc ? argv[optind] : RECORDER_PATH;
+
+    struct rec_reader *r = rec_reader_open(path);
+    if (!r) {
+        fprintf(stderr, "%s: %s\n", path,
+                errno == EINVAL ? "not an rc_sched sample log"
+                                : strerror(errno));
+        return 1;
+    }
+
+    if (csv)
+        printf("time,valid,temp_c,pred_c,freq_ghz,power_w,util_pct,"
+               "mitigation,idle_pct,cap_khz,uclamp_pct\n");
+
+    /* Deltas only decode forward from a key frame: count, then print */
+    struct rec_sample s;
+    unsigned long long total = 0, i = 0;
+    if (tail) {
+        while (rec_reader_next(r, &s))
+            total++;
+        rec_reader_rewind(r);
+    }
+    unsigned long long skip = tail && tail < total ? total - tail : 0;
+
+    while (rec_reader_next(r, &s))
+        if (i++ >= skip)
+            print_sample(&s);
+
+    if (!csv) {
+        uint64_t w = rec_reader_written(r), n = rec_reader_capacity(r);
+        fprintf(stderr, "%llu samples, %llu slots written, %llu in log\n",
+                i, (unsigned long long)w,
+                (unsigned long long)(w < n ? w : n));
+    }
+
+    rec_reader_close(r);
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+ * rc_headroom — show or wait for rc_sched's thermal headroom
+ *
+ * Usage: rc_headroom [--path FILE] [--watts W [--for SEC]
+ *                    [--wait] [--timeout MS]]
+ *
+ * Without --wait, prints the current headroom and, with --watts, how
+ * long that much extra load could run. With --wait, blocks until W
+ * more watts fit for SEC seconds (default: indefinitely) and exits 0,
+ * or exits 1 on timeout: usable as a gate in batch job scripts.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+
+#include "rc_headroom.h"
+
+static void print_headroom(const struct rc_headroom_data *d)
+{
+    if (!d->valid) {
+        printf("no valid sample\n");
+        return;
+    }
+
+    printf("T=%.2f°C T_high=%.1f°C P=%.2f W mitigation=%u\n",
+           d->temp_c, d->t_high, d->power_w, d->mitigation_level);
+    printf("sustained headroom %+.2f W", d->watts);
+    if (isinf(d->seconds))
+        printf(", T_high not reached at current load\n");
+    else
+        printf(", T_high in %.0f s at current load\n", d->seconds);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "path",    required_argument, NULL, 'p' },
+        { "watts",   required_argument, NULL, 'w' },
+        { "for",     required_argument, NULL, 'f' },
+        { "wait",    no_argument,       NULL, 'W' },
+        { "timeout", required_argument, NULL, 't' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char *path = NULL;
+    double watts = NAN, seconds = INFINITY;
+    int wait = 0, timeout_ms = -1;
+    int c;
+
+    while ((c = getopt_long(argc, argv, "p:w:f:Wt:", opts, NULL)) != -1) {
+        switch (c) {
+        case 'p': path = optarg; break;
+        case 'w': watts = atof(optarg); break;
+        case 'f': seconds = atof(optarg); break;
+        case 'W': wait = 1; break;
+        case 't': timeout_ms = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [--path FILE] [--watts W [--for SEC] "
+                    "[--wait] [--timeout MS]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (wait && isnan(watts)) {
+        fprintf(stderr, "--wait needs --watts\n");
+        return 2;
+    }
+
+    struct rc_headroom *h = rc_headroom_open(path);
+    if (!h) {
+        fprintf(stderr, "%s: not available (is rc_sched running?)\n",
+                path ? path : RC_HEADROOM_PATH);
+        return 2;
+    }
+
+    struct rc_headroom_data d;
+    int rc = 0;
+
+    if (wait) {
+        if (rc_headroom_wait(h, watts, seconds, timeout_ms, &d) < 0) {
+            fprintf(stderr, "timed out waiting for %.2f W of headroom\n",
+                    watts);
+            rc = 1;
+        }
+        else {
+            print_headroom(&d);
+        }
+    }
+    else if (rc_headroom_read(h, &d) < 0) {
+        fprintf(stderr, "could not take a consistent snapshot\n");
+        rc = 2;
+    }
+    else {
+        print_headroom(&d);
+        if (!isnan(watts) && d.valid) {
+            double t = rc_headroom_seconds(&d, watts);
+            if (isinf(t))
+                printf("+%.2f W: sustainable\n", watts);
+            else
+                printf("+%.2f W: T_high in %.0f s\n", watts, t);
+        }
+    }
+
+    rc_headroom_close(h);
+    return rc;
+}
@@ -0,0 +1,140 @@
+/*
+ * rc_sim — run the controller against the simulated plant
+ *
+ * Usage: rc_sim [options]   (see --help)
+ *
+ * The controller takes its parameters from --config as the daemon
+ * does; the plant and workload come from the options below. Prints
+ * the controller's decisions on the simulated clock, then the score.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "sim.h"
+#include "controller.h"
+#include "config.h"
+
+static void usage(const char *prog, const struct sim_config *d)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -c, --config FILE      controller parameters (default: "
+            "built-in)\n"
+            "  -w, --workload KIND    steady, bursty or diurnal\n"
+            "  -l, --level X          demand as a share of f_max (%.2f)\n"
+            "  -L, --low X            demand between bursts / at night "
+            "(%.2f)\n"
+            "  -d, --duration SEC     simulated time (%.0f)\n"
+            "  -P, --period SEC       diurnal period (%.0f)\n"
+            "  -T, --control-period S seconds between decisions (%.2f)\n"
+            "  -R, --r-thermal K/W    plant resistance (%.2f)\n"
+            "  -C, --c-thermal J/K    plant capacitance (%.1f)\n"
+            "  -a, --ambient C        ambient temperature (%.1f)\n"
+            "  -f, --f-max GHz        maximum frequency (%.2f)\n"
+            "  -s, --seed N           workload and sensor noise seed\n"
+            "  -q, --quiet            only print the score\n"
+            "  -j, --json             score as one JSON line\n",
+            prog, d->level, d->low, d->duration, d->period,
+            d->control_period, d->r_thermal, d->c_thermal, d->t_ambient,
+            d->f_max_ghz);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "config",         required_argument, NULL, 'c' },
+        { "workload",       required_argument, NULL, 'w' },
+        { "level",          required_argument, NULL, 'l' },
+        { "low",            required_argument, NULL, 'L' },
+        { "duration",       required_argument, NULL, 'd' },
+        { "period",         required_argument, NULL, 'P' },
+        { "control-period", required_argument, NULL, 'T' },
+        { "r-thermal",      required_argument, NULL, 'R' },
+        { "c-thermal",      required_argument, NULL, 'C' },
+        { "ambient",        required_argument, NULL, 'a' },
+        { "f-max",          required_argument, NULL, 'f' },
+        { "seed",           required_argument, NULL, 's' },
+        { "quiet",          no_argument,       NULL, 'q' },
+        { "json",           no_argument,       NULL, 'j' },
+        { "help",           no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    struct sim_config c;
+    const char *config_path = NULL;
+    int quiet = 0, json = 0, opt;
+
+    sim_defaults(&c);
+
+    while ((opt = getopt_long(argc, argv, "c:w:l:L:d:P:T:R:C:a:f:s:qjh",
+                              opts, NULL)) != -1) {
+        switch (opt) {
+        case 'c': config_path = optarg; break;
+        case 'w':
+            if ((int)(c.workload = sim_workload_parse(optarg)) < 0) {
+                fprintf(stderr, "unknown workload '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'l': c.level = atof(optarg); break;
+        case 'L': c.low = atof(optarg); break;
+        case 'd': c.duration = atof(optarg); break;
+        case 'P': c.period = atof(optarg); break;
+        case 'T': c.control_period = atof(optarg); break;
+        case 'R': c.r_thermal = atof(optarg); break;
+        case 'C': c.c_thermal = atof(optarg); break;
+        case 'a': c.t_ambient = atof(optarg); break;
+        case 'f': c.f_max_ghz = atof(optarg); break;
+        case 's': c.seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'q': quiet = 1; break;
+        case 'j': json = 1; quiet = 1; break;
+        default:
+            usage(argv[0], &c);
+            return 1;
+        }
+    }
+
+    if (c.duration <= 0 || c.control_period <= 0 || c.r_thermal <= 0 ||
+        c.c_thermal <= 0 || c.f_max_ghz <= 0) {
+        fprintf(stderr, "durations and plant parameters must be positive\n");
+        return 1;
+    }
+
+    if (config_path && config_reload(config_path, 0) < 0)
+        return 1;
+
+    controller_configure(0, 0);
+    controller_quiet(quiet);
+
+    struct sim_result r;
+    sim_run(&c, &controller_ops, &r);
+
+    double share = r.offered > 0 ? r.delivered / r.offered : 1.0;
+    if (json) {
+        printf("{\"duration_s\":%.1f,\"offered_gcycles\":%.1f,"
+               "\"delivered_gcycles\":%.1f,\"delivered_share\":%.4f,"
+               "\"peak_c\":%.2f,\"mean_c\":%.2f,\"above_high_s\":%.1f,"
+               "\"above_critical_s\":%.1f,\"capped_s\":%.1f,"
+               "\"cap_writes\":%llu,\"idle_starts\":%llu}\n",
+               r.duration, r.offered, r.delivered, share, r.peak_temp,
+               r.mean_temp, r.above_high, r.above_critical, r.capped,
+               r.cap_writes, r.idle_starts);
+    }
+    else {
+        printf("\nSimulation score\n");
+        printf("  delivered work   %.1f of %.1f Gcycles (%.2f%%)\n",
+               r.delivered, r.offered, 100.0 * share);
+        printf("  peak T           %.2f °C (mean %.2f)\n",
+               r.peak_temp, r.mean_temp);
+        printf("  time > T_HIGH    %.1f s (%.2f%%)\n",
+               r.above_high, 100.0 * r.above_high / r.duration);
+        printf("  time > T_CRIT    %.1f s\n", r.above_critical);
+        printf("  capped           %.1f s, %llu cap writes, "
+               "%llu idle injections\n",
+               r.capped, r.cap_writes, r.idle_starts);
+    }
+
+    params_shutdown();
+    return 0;
+}
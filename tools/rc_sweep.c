@@ -0,0 +1,469 @@
+/*
+ * rc_sweep — search controller parameters over a trace or the simulator
+ *
+ * Usage: rc_sweep [options] -p key=lo:hi[:step] [-p ...]
+ *
+ * Every axis is a config file key. Without --random the full grid is
+ * run (step defaults to (hi - lo) / 4); with --random N, N points are
+ * drawn uniformly from the box. Prints the Pareto front of throughput
+ * retained versus peak temperature as JSON lines, best-cooled first.
+ *
+ * Runs are spread over forked workers, each owning a range of run
+ * indices in shared memory; an idle worker steals the upper half of
+ * the fullest-looking range it finds. Processes rather than threads
+ * because the controller keeps its state per process.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "config.h"
+#include "controller.h"
+#include "replay.h"
+#include "sim.h"
+
+#define SWEEP_MAX_AXES      8
+#define SWEEP_MAX_WORKERS   256
+#define SWEEP_MAX_RUNS      (1u << 24)
+
+struct axis {
+    const char *key;
+    double lo, hi, step;
+    unsigned n;                 // grid points
+};
+
+struct run {
+    double v[SWEEP_MAX_AXES];
+    double throughput;          // share of work retained
+    double peak;                // °C
+    double above_high;          // s
+    unsigned long long actions;
+    int status;                 // 0 pending, 1 done, -1 invalid set
+};
+
+/* Shared between workers */
+struct pool {
+    struct {
+        _Alignas(64) atomic_ullong range;   // lo << 32 | hi
+    } q[SWEEP_MAX_WORKERS];
+    _Alignas(64) atomic_ullong done;
+    atomic_ullong steals;
+};
+
+static struct axis axes[SWEEP_MAX_AXES];
+static int n_axes = 0;
+static struct run *runs;
+static struct pool *pool;
+static int n_workers;
+
+static struct rc_params base;
+static struct replay_trace *trace = NULL;
+static struct sim_config sim;
+
+static uint64_t pack(uint32_t lo, uint32_t hi)
+{
+    return (uint64_t)lo << 32 | hi;
+}
+
+/* =======================
+   Work stealing
+   ======================= */
+static int take(int w, uint32_t *idx)
+{
+    atomic_ullong *r = &pool->q[w].range;
+    uint64_t v = atomic_load(r);
+
+    for (;;) {
+        uint32_t lo = v >> 32, hi = (uint32_t)v;
+        if (lo >= hi)
+            return 0;
+        if (atomic_compare_exchange_weak(r, &v, pack(lo + 1, hi))) {
+            *idx = lo;
+            return 1;
+        }
+    }
+}
+
+static int steal(int w, uint64_t *rng)
+{
+    *rng ^= *rng << 13;
+    *rng ^= *rng >> 7;
+    *rng ^= *rng << 17;
+    int start = (int)(*rng % (uint64_t)n_workers);
+
+    for (int k = 0; k < n_workers; k++) {
+        int victim = (start + k) % n_workers;
+        if (victim == w)
+            continue;
+
+        atomic_ullong *r = &pool->q[victim].range;
+        uint64_t v = atomic_load(r);
+        for (;;) {
+            uint32_t lo = v >> 32, hi = (uint32_t)v;
+            if (lo >= hi)
+                break;
+            uint32_t mid = hi - (hi - lo + 1) / 2;
+            if (atomic_compare_exchange_weak(r, &v, pack(lo, mid))) {
+                /* Only thieves look at an empty range, and they skip it */
+                atomic_store(&pool->q[w].range, pack(mid, hi));
+                atomic_fetch_add(&pool->steals, 1);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* =======================
+   One run
+   ======================= */
+static void evaluate(struct run *r)
+{
+    struct rc_params p = base;
+    char err[128];
+
+    for (int a = 0; a < n_axes; a++)
+        params_set_key(&p, axes[a].key, r->v[a]);
+
+    if (params_validate(&p, err, sizeof(err)) < 0) {
+        r->status = -1;
+        return;
+    }
+
+    params_publish(&p);
+    controller_reset();
+
+    if (trace) {
+        struct replay_result res;
+        replay_run(trace, &controller_ops, &base, &res);
+        r->throughput = res.work_share;
+        r->peak = res.peak;
+        r->above_high = res.above_high;
+        r->actions = res.cap_writes + res.idle_starts;
+    }
+    else {
+        struct sim_result res;
+        sim_run(&sim, &controller_ops, &res);
+        r->throughput = res.offered > 0 ? res.delivered / res.offered : 1.0;
+        r->peak = res.peak_temp;
+        r->above_high = res.above_high;
+        r->actions = res.cap_writes + res.idle_starts;
+    }
+    r->status = 1;
+}
+
+static void worker(int w)
+{
+    uint64_t rng = 0x9E3779B97F4A7C15ULL * (w + 1);
+    uint32_t idx;
+
+    controller_configure(0, 0);
+    controller_quiet(1);
+
+    for (;;) {
+        while (take(w, &idx)) {
+            evaluate(&runs[idx]);
+            atomic_fetch_add(&pool->done, 1);
+        }
+        if (!steal(w, &rng))
+            break;
+    }
+
+    _exit(0);
+}
+
+/* =======================
+   Run set
+   ======================= */
+static int parse_axis(const char *spec)
+{
+    if (n_axes == SWEEP_MAX_AXES) {
+        fprintf(stderr, "at most %d parameters\n", SWEEP_MAX_AXES);
+        return -1;
+    }
+
+    char key[32];
+    struct axis *a = &axes[n_axes];
+    int n = sscanf(spec, "%31[^=]=%lf:%lf:%lf", key, &a->lo, &a->hi,
+                   &a->step);
+    struct rc_params probe;
+    if (n < 3 || a->hi < a->lo || params_set_key(&probe, key, 0) < 0) {
+        fprintf(stderr, "bad parameter '%s' (want key=lo:hi[:step])\n",
+                spec);
+        return -1;
+    }
+    if (n < 4 || a->step <= 0)
+        a->step = a->hi > a->lo ? (a->hi - a->lo) / 4 : 1.0;
+
+    a->key = strdup(key);
+    a->n = (unsigned)((a->hi - a->lo) / a->step + 1e-9) + 1;
+    n_axes++;
+    return 0;
+}
+
+static size_t build_runs(size_t n_random, unsigned seed)
+{
+    size_t n = 1;
+
+    if (n_random) {
+        n = n_random;
+    }
+    else {
+        for (int a = 0; a < n_axes; a++) {
+            n *= axes[a].n;
+            if (n > SWEEP_MAX_RUNS)
+                break;
+        }
+    }
+    if (n > SWEEP_MAX_RUNS) {
+        fprintf(stderr, "too many runs (max %u)\n", SWEEP_MAX_RUNS);
+        return 0;
+    }
+
+    runs = mmap(NULL, n * sizeof(*runs), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (runs == MAP_FAILED)
+        return 0;
+
+    srand48(seed);
+    for (size_t i = 0; i < n; i++) {
+        size_t rest = i;
+        for (int a = 0; a < n_axes; a++) {
+            if (n_random) {
+                runs[i].v[a] = axes[a].lo +
+                               drand48() * (axes[a].hi - axes[a].lo);
+            }
+            else {
+                runs[i].v[a] = axes[a].lo + (rest % axes[a].n) * axes[a].step;
+                rest /= axes[a].n;
+            }
+        }
+    }
+
+    return n;
+}
+
+/* =======================
+   Output
+   ======================= */
+static void print_run(const struct run *r)
+{
+    printf("{");
+    for (int a = 0; a < n_axes; a++)
+        printf("\"%s\":%g,", axes[a].key, r->v[a]);
+    printf("\"throughput\":%.5f,\"peak_c\":%.2f,\"above_high_s\":%.1f,"
+           "\"actions\":%llu}\n",
+           r->throughput, r->peak, r->above_high, r->actions);
+}
+
+static int by_peak(const void *a, const void *b)
+{
+    const struct run *x = *(struct run * const *)a;
+    const struct run *y = *(struct run * const *)b;
+    if (x->peak != y->peak)
+        return x->peak < y->peak ? -1 : 1;
+    return (x->throughput < y->throughput) - (x->throughput > y->throughput);
+}
+
+/* Non-dominated runs: nothing is both cooler and retains more work */
+static void print_front(size_t n)
+{
+    struct run **order = malloc(n * sizeof(*order));
+    size_t m = 0;
+    if (!order)
+        return;
+
+    for (size_t i = 0; i < n; i++)
+        if (runs[i].status == 1)
+            order[m++] = &runs[i];
+    qsort(order, m, sizeof(*order), by_peak);
+
+    double best = -1.0;
+    for (size_t i = 0; i < m; i++) {
+        if (order[i]->throughput > best) {
+            print_run(order[i]);
+            best = order[i]->throughput;
+        }
+    }
+
+    free(order);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] -p key=lo:hi[:step] [-p ...]\n"
+            "  -p, --param SPEC       sweep a config key over lo..hi\n"
+            "  -n, --random N         N random points instead of the grid\n"
+            "  -c, --config FILE      base parameters (default: built-in)\n"
+            "  -t, --trace FILE       replay a trace (sample log or text)\n"
+            "  -w, --workload KIND    else simulate: steady, bursty, diurnal\n"
+            "  -d, --duration SEC     simulated time\n"
+            "  -l, --level X          simulated demand, share of f_max\n"
+            "  -s, --seed N           sampling and workload seed\n"
+            "  -j, --jobs N           worker processes (default: all CPUs)\n"
+            "  -a, --all              print every run, not just the front\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option opts[] = {
+        { "param",    required_argument, NULL, 'p' },
+        { "random",   required_argument, NULL, 'n' },
+        { "config",   required_argument, NULL, 'c' },
+        { "trace",    required_argument, NULL, 't' },
+        { "workload", required_argument, NULL, 'w' },
+        { "duration", required_argument, NULL, 'd' },
+        { "level",    required_argument, NULL, 'l' },
+        { "seed",     required_argument, NULL, 's' },
+        { "jobs",     required_argument, NULL, 'j' },
+        { "all",      no_argument,       NULL, 'a' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char *config_path = NULL, *trace_path = NULL;
+    size_t n_random = 0;
+    unsigned seed = 1;
+    int all = 0, opt;
+
+    sim_defaults(&sim);
+    n_workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    while ((opt = getopt_long(argc, argv, "p:n:c:t:w:d:l:s:j:ah", opts,
+                              NULL)) != -1) {
+        switch (opt) {
+        case 'p':
+            if (parse_axis(optarg) < 0)
+                return 1;
+            break;
+        case 'n': n_random = strtoul(optarg, NULL, 10); break;
+        case 'c': config_path = optarg; break;
+        case 't': trace_path = optarg; break;
+        case 'w':
+            if ((int)(sim.workload = sim_workload_parse(optarg)) < 0) {
+                fprintf(stderr, "unknown workload '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'd': sim.duration = atof(optarg); break;
+        case 'l': sim.level = atof(optarg); break;
+        case 's': seed = sim.seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'j': n_workers = atoi(optarg); break;
+        case 'a': all = 1; break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (n_axes == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (n_workers < 1)
+        n_workers = 1;
+    if (n_workers > SWEEP_MAX_WORKERS)
+        n_workers = SWEEP_MAX_WORKERS;
+
+    params_defaults(&base);
+    if (config_path) {
+        char err[256];
+        if (params_parse(config_path, &base, err, sizeof(err)) < 0) {
+            fprintf(stderr, "config: %s\n", err);
+            return 1;
+        }
+    }
+
+    /* Loaded once; workers share the pages copy-on-write */
+    if (trace_path && !(trace = replay_load(trace_path))) {
+        fprintf(stderr, "%s: %s\n", trace_path,
+                errno == EINVAL ? "unreadable sample log" : strerror(errno));
+        return 1;
+    }
+
+    size_t n = build_runs(n_random, seed);
+    if (n == 0)
+        return 1;
+    if ((size_t)n_workers > n)
+        n_workers = (int)n;
+
+    pool = mmap(NULL, sizeof(*pool), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (pool == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    for (int w = 0; w < n_workers; w++)
+        atomic_store(&pool->q[w].range,
+                     pack((uint32_t)(n * w / n_workers),
+                          (uint32_t)(n * (w + 1) / n_workers)));
+
+    double start = now_s();
+    fflush(stdout);
+    for (int w = 0; w < n_workers; w++) {
+        pid_t pid = fork();
+        if (pid == 0)
+            worker(w);
+        if (pid < 0) {
+            perror("fork");
+            n_workers = w;
+            break;
+        }
+    }
+
+    int tty = isatty(STDERR_FILENO), alive = n_workers, failed = 0;
+    while (alive > 0) {
+        int st;
+        pid_t pid = waitpid(-1, &st, tty ? WNOHANG : 0);
+        if (pid > 0) {
+            alive--;
+            failed |= !WIFEXITED(st) || WEXITSTATUS(st) != 0;
+            continue;
+        }
+        if (pid < 0 && errno != EINTR)
+            break;
+        fprintf(stderr, "\r%llu/%zu runs", atomic_load(&pool->done), n);
+        usleep(200000);
+    }
+    double elapsed = now_s() - start;
+
+    if (failed)
+        fprintf(stderr, "\nworker died; results are partial\n");
+
+    size_t invalid = 0;
+    for (size_t i = 0; i < n; i++)
+        invalid += runs[i].status == -1;
+
+    if (all) {
+        for (size_t i = 0; i < n; i++)
+            if (runs[i].status == 1)
+                print_run(&runs[i]);
+    }
+    else {
+        print_front(n);
+    }
+
+    fprintf(stderr, "%s%zu runs (%zu invalid) on %d workers in %.1f s, "
+            "%llu steals\n", tty ? "\r" : "", n, invalid, n_workers,
+            elapsed, atomic_load(&pool->steals));
+
+    replay_free(trace);
+    return failed;
+}